@@ -1,5 +1,8 @@
 #include "AI.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <thread>
 #include "time.h"
 
 /******************************************************************************
@@ -7,37 +10,790 @@
  * Method: AI::AI()
  *
  *****************************************************************************/
-AI::AI(Color to_control, Difficulty d, BoardManager* game)
+AI::AI(Color to_control, Difficulty d, BoardManager* game, size_t hash_mb,
+       int threads)
   : _controlling(to_control),
+    _game(game),
     _difficulty(d),
-    _game(game)
-{}
+    _limits(limitsFor(d)),
+    _tt(hash_mb)
+{
+  Endgame::init();
+  for (int i = 0; i < std::max(threads, 1); i++) {
+    _threads.push_back(std::make_unique<SearchThread>());
+    _threads.back()->id = i;
+  }
+}
+
+/******************************************************************************
+ *
+ * Method: AI::limitsFor(Difficulty)
+ * - the search budget for each difficulty, the easier two dont search
+ *****************************************************************************/
+AI::Limits AI::limitsFor(Difficulty d)
+{
+  switch (d) {
+    case HARD:
+      return Limits { 5, 1000000 };
+    case IMPOSSIBLE:
+      return Limits { MAX_PLY - 1, 2000000 };
+    default:
+      return Limits { 1, 0 };
+  }
+}
 
 /******************************************************************************
  *
  * Method: AI::move()
  *
  *****************************************************************************/
-Move AI::move()
+PackedMove AI::move()
 {
-  auto possible =
-    _game->genPossibleOpposing(_controlling == WHITE ? BLACK : WHITE);
+  switch (_difficulty) {
+    case EASY:
+    case MEDIUM:
+      return decent_move(_game->genLegal(_controlling));
+    case HARD:
+    case IMPOSSIBLE:
+    default:
+      if (auto book = bookMove()) {
+        return book;
+      }
+      _time.clear();
+      _stop = false;
+      return search(*_game, _limits);
+  }
+}
 
+/******************************************************************************
+ *
+ * Method: AI::move(const Clock&)
+ *
+ *****************************************************************************/
+PackedMove AI::move(const Clock& clock)
+{
   switch (_difficulty) {
     case EASY:
     case MEDIUM:
+      return decent_move(_game->genLegal(_controlling));
     case HARD:
     case IMPOSSIBLE:
-      return decent_move(possible);
+    default:
+      if (auto book = bookMove()) {
+        return book;
+      }
+      _time.start(clock);
+      _stop = false;
+      return search(*_game, Limits { _limits.depth, 0 });
+  }
+}
+
+/******************************************************************************
+ *
+ * Method: AI::bookMove()
+ * - probed on the main thread's scratch board, decoding the entry needs
+ *   the legal moves and the live game may be on screen
+ *****************************************************************************/
+PackedMove AI::bookMove()
+{
+  if (!_book.loaded() || !_game->colorMatchesTurn(_controlling)) {
+    return PackedMove {};
+  }
+
+  auto& board = _threads[0]->board;
+  board = *_game;
+  const auto move = _book.probe(board);
+  if (move) {
+    if (_verbose) {
+      std::cout << "book move " << moveToString(move) << "\n";
+    }
+    // no line to expect a reply from
+    _ponder_move = PackedMove {};
+  }
+  return move;
+}
+
+/******************************************************************************
+ *
+ * Method: AI::startPonder(const Clock&)
+ *
+ *****************************************************************************/
+bool AI::startPonder(const Clock& clock)
+{
+  if (_difficulty < HARD || !_ponder_move) {
+    return false;
+  }
+
+  // the expected reply came from the last search, check it still fits
+  const auto legal = _game->genLegal(_game->sideToMove());
+  if (std::find(legal.begin(), legal.end(), _ponder_move) == legal.end()) {
+    return false;
+  }
+
+  if (_verbose) {
+    std::cout << "pondering on " << moveToString(_ponder_move) << "\n";
+  }
+  _ponder_root = *_game;
+  _ponder_root.makeMove(_ponder_move);
+  _time.start(clock);
+  _stop = false;
+  _stop_on_ponderhit = false;
+  _pondering = true;
+  return true;
+}
+
+/******************************************************************************
+ *
+ * Method: AI::ponder()
+ *
+ *****************************************************************************/
+PackedMove AI::ponder()
+{
+  const auto best = search(_ponder_root, Limits { _limits.depth, 0 });
+
+  // still set means it was stopped without a ponderhit
+  if (_pondering.exchange(false)) {
+    return PackedMove {};
+  }
+  return best;
+}
+
+/******************************************************************************
+ *
+ * Method: AI::ponderhit()
+ * - a search that already used the time a normal one would have stops
+ *   here, one that ran out of depth is let go by clearing the flag
+ *****************************************************************************/
+void AI::ponderhit()
+{
+  if (_verbose) {
+    std::cout << "ponderhit\n";
+  }
+  _pondering = false;
+  if (_stop_on_ponderhit) {
+    _stop = true;
+  }
+}
+
+/******************************************************************************
+ *
+ * Method: AI::search(const BoardManager&, const Limits&)
+ * - lazy SMP, the threads only share the table and the main one's move
+ *   is played
+ *****************************************************************************/
+PackedMove AI::search(const BoardManager& root, const Limits& limits)
+{
+  if (root.sideToMove() != _controlling) {
+    return PackedMove {};
+  }
+
+  _running = limits;
+  _tt.newSearch();
+  for (auto& t : _threads) {
+    t->board = root;
+    t->nodes = 0;
+    t->tt_probes = 0;
+    t->tt_hits = 0;
+    t->root_best = PackedMove {};
+    t->root_ponder = PackedMove {};
+    t->null_min_ply = 0;
+    t->ordering.newSearch();
+  }
+
+  std::vector<std::thread> helpers;
+  for (size_t i = 1; i < _threads.size(); i++) {
+    helpers.emplace_back([this, i] { iterate(*_threads[i]); });
+  }
+
+  auto& main = *_threads[0];
+  iterate(main);
+
+  // a search that ran out of depth while pondering still has to wait to
+  // hear whether its move is wanted, the helpers go on meanwhile
+  while (_pondering.load(std::memory_order_acquire) && !_stop) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  _stop = true;
+  for (auto& helper : helpers) {
+    helper.join();
+  }
+
+  if (_verbose) {
+    const auto stats = hashStats();
+    const auto ordering = orderingStats();
+    std::cout << "hash hits " << int(stats.hitRate() * 100) << "% full "
+              << stats.hashfull / 10 << "% first move cutoffs "
+              << int(ordering.firstMoveRate() * 100) << "%\n";
+  }
+
+  if (!main.root_best) {
+    // out of budget before the first root move finished
+    const auto legal = main.board.genLegal(main.board.sideToMove());
+    if (!legal.empty()) {
+      main.root_best = legal[0];
+    }
+  }
+  _ponder_move = main.root_ponder;
+  return main.root_best;
+}
+
+/******************************************************************************
+ *
+ * Method: AI::iterate(SearchThread&)
+ * - iterative deepening, each depth's best move is tried first at the next
+ *****************************************************************************/
+void AI::iterate(SearchThread& t)
+{
+  const bool main = t.id == 0;
+
+  // every other helper starts a ply deeper so they dont all search the
+  // same depth at once
+  for (int depth = 1 + (t.id & 1); depth <= _running.depth; depth++) {
+    const int score = negamax(t, depth, -INF, INF, 0);
+
+    // a depth cut short still has a line if a root move beat the last best
+    if (t.pv_length[0] > 0) {
+      t.root_best = t.pv[0][0];
+      t.root_ponder = t.pv_length[0] > 1 ? t.pv[0][1] : PackedMove {};
+    }
+
+    if (_stop.load(std::memory_order_relaxed)) {
+      break;
+    }
+
+    if (main && _verbose) {
+      std::cout << "depth " << depth << " score " << score
+                << " nodes " << totalNodes() << " pv";
+      for (int i = 0; i < t.pv_length[0]; i++) {
+        std::cout << " " << moveToString(t.pv[0][i]);
+      }
+      std::cout << "\n";
+    }
+
+    // nothing deeper will change a forced mate
+    if (std::abs(score) >= MATE - MAX_PLY) {
+      break;
+    }
+
+    // the next depth usually takes longer than all of these together,
+    // so dont start one that wont finish. While pondering the ponderhit
+    // does the stopping, the flag is read again in case it came between
+    if (main && _time.active() && _time.elapsed() >= _time.optimum() / 2) {
+      if (!_pondering) {
+        break;
+      }
+      _stop_on_ponderhit = true;
+      if (!_pondering) {
+        break;
+      }
+    }
+  }
+}
+
+/******************************************************************************
+ *
+ * Method: AI::checkLimits()
+ * - only the main thread looks, every 1024 nodes, and stops everyone.
+ *   That is well under a millisecond between checks
+ *****************************************************************************/
+void AI::checkLimits()
+{
+  // no budget on the opponent's time
+  if (_pondering.load(std::memory_order_acquire)) {
+    return;
+  }
+
+  if (_running.nodes && totalNodes() >= _running.nodes) {
+    _stop = true;
+  }
+
+  if (_time.active() && _time.elapsed() >= _time.maximum()) {
+    _stop = true;
+  }
+}
+
+/******************************************************************************
+ *
+ * Method: AI::totalNodes()
+ *
+ *****************************************************************************/
+uint64_t AI::totalNodes() const
+{
+  uint64_t nodes = 0;
+  for (const auto& t : _threads) {
+    nodes += t->nodes.load(std::memory_order_relaxed);
+  }
+  return nodes;
+}
+
+/******************************************************************************
+ *
+ * Method: AI::negamax(SearchThread&, depth, alpha, beta, ply)
+ * - alpha-beta from the side to move's point of view, a mate is scored by
+ *   how many plies away it is so the shortest one is preferred
+ *****************************************************************************/
+int AI::negamax(SearchThread& t, int depth, int alpha, int beta, int ply)
+{
+  auto& board = t.board;
+  t.pv_length[ply] = ply;
+
+  // a repeat inside the search is treated as a draw straight away
+  if (ply > 0 && board.repetitions() >= 1) {
+    return 0;
+  }
+
+  // so is the 50 move rule, unless the move that got there was mate
+  if (ply > 0 && board.HalfMoveClock() >= 100) {
+    const auto us = board.sideToMove();
+    return board.isColorInCheck(us) && board.genLegal(us).empty()
+      ? -MATE + ply
+      : 0;
+  }
+
+  // endings with a known result need no searching below the root
+  if (ply > 0) {
+    const auto known = Endgame::probe(board);
+    if (known.kind == Endgame::Verdict::EXACT) {
+      return known.score;
+    }
+  }
+
+  if (depth <= 0) {
+    return quiesce(t, alpha, beta, ply);
+  }
+
+  if (_stop.load(std::memory_order_relaxed)) {
+    return 0;
+  }
+
+  const auto nodes = t.nodes.load(std::memory_order_relaxed) + 1;
+  t.nodes.store(nodes, std::memory_order_relaxed);
+  if (t.id == 0 && (nodes & 1023) == 0) {
+    checkLimits();
+  }
+
+  if (ply >= MAX_PLY - 1) {
+    return evaluateBoard(board);
+  }
+
+  // a deep enough stored result ends the search here, except at the root
+  // which has to come back with a move
+  const int alpha_start = alpha;
+  PackedMove tt_move {};
+  TranspositionTable::Entry entry;
+  t.tt_probes++;
+  if (_tt.probe(board.key(), entry)) {
+    t.tt_hits++;
+    tt_move = entry.move;
+
+    const int score = scoreFromTT(entry.score, ply);
+    if (ply > 0 && entry.depth >= depth &&
+        (entry.bound == TranspositionTable::EXACT ||
+         (entry.bound == TranspositionTable::LOWER && score >= beta) ||
+         (entry.bound == TranspositionTable::UPPER && score <= alpha)))
+    {
+      return score;
+    }
+  }
+
+  auto moves = board.genLegal(board.sideToMove());
+  const auto us = board.sideToMove();
+  const bool in_check = board.isColorInCheck(us);
+  if (moves.empty()) {
+    return in_check ? -MATE + ply : 0;
+  }
+
+  // a window wider than one point means the score itself is wanted,
+  // nothing is pruned on a guess there
+  const bool pv_node = beta - alpha > 1;
+  const bool mate_window = std::abs(beta) >= MATE - MAX_PLY ||
+                           std::abs(alpha) >= MATE - MAX_PLY;
+  const bool selective = ply > 0 && !pv_node && !in_check && !mate_window;
+  const int static_eval = selective ? evaluateBoard(board) : -INF;
+
+  // reverse futility, so far above beta that the last plies wont bring
+  // it back down
+  if (selective && _pruning.futility && depth <= FUTILITY_DEPTH &&
+      static_eval - FUTILITY_MARGIN * depth >= beta)
+  {
+    return static_eval;
+  }
+
+  // so far below alpha that only a capture could help, ask quiescence
+  if (selective && _pruning.razoring && depth <= RAZOR_DEPTH &&
+      static_eval + RAZOR_MARGIN * depth < alpha)
+  {
+    const int score = quiesce(t, alpha, beta, ply);
+    if (score < alpha) {
+      return score;
+    }
+  }
+
+  // if passing still holds beta a real move will too. Not twice in a row,
+  // and not with only pawns left where passing may be the best move there
+  // is. Deep cutoffs are verified by a search without null moves
+  const Bitboard pieces = board.occupancy(us) &
+    ~(board.pieces(us, PAWN) | board.pieces(us, KING));
+  if (selective && _pruning.null_move && depth >= 3 &&
+      ply >= t.null_min_ply && static_eval >= beta && pieces &&
+      board.lastMove())
+  {
+    const int r = depth >= 6 ? 3 : 2;
+
+    board.makeNullMove();
+    int score = -negamax(t, depth - 1 - r, -beta, -beta + 1, ply + 1);
+    board.unmakeNullMove();
+
+    if (_stop.load(std::memory_order_relaxed)) {
+      return 0;
+    }
+
+    if (score >= beta) {
+      // a mate found after passing isnt a real one
+      if (score >= MATE - MAX_PLY) {
+        score = beta;
+      }
+
+      if (depth < NULL_VERIFY_DEPTH) {
+        return score;
+      }
+
+      // a verification inside another one keeps the outer one's limit
+      // once it is done
+      const int outer_min_ply = t.null_min_ply;
+      t.null_min_ply = ply + 3 * (depth - r) / 4;
+      const int verified = negamax(t, depth - r, beta - 1, beta, ply);
+      t.null_min_ply = outer_min_ply;
+      if (verified >= beta) {
+        return score;
+      }
+    }
+  }
+
+  // near the leaves quiet moves cant lift a score this low to alpha,
+  // only the first move and moves that give check are searched
+  const bool futile = selective && _pruning.futility &&
+                      depth <= FUTILITY_DEPTH &&
+                      static_eval + FUTILITY_MARGIN * depth <= alpha;
+
+  MovePicker picker(board, moves, t.ordering,
+                    ply == 0 && t.root_best ? t.root_best : tt_move, ply);
+
+  // quiet moves that didnt cause a cutoff, their history goes down
+  // when a later one does
+  std::array<PackedMove, MoveList::MAX_MOVES> quiets;
+  int quiet_count = 0;
+  int searched = 0;
+
+  int best = -INF;
+  PackedMove best_move {};
+  while (const auto m = picker.next()) {
+    const bool quiet = !m.isCapture() && !m.isPromotion();
+
+    // late quiet moves are searched shallower with a null window, and
+    // again in full only if they turn out better than expected
+    int r = 0;
+    if (_pruning.late_move_reductions && quiet && !in_check &&
+        depth >= 3 && searched >= 3)
+    {
+      r = reduction(t, m, depth, searched, ply, pv_node);
+    }
+
+    board.makeMove(m);
+    const bool gives_check = (futile || r > 0) &&
+                             board.isColorInCheck(board.sideToMove());
+
+    if (futile && quiet && searched > 0 && !gives_check) {
+      board.unmakeMove();
+      continue;
+    }
+    if (gives_check) {
+      r = 0;
+    }
+
+    int score;
+    if (searched == 0) {
+      score = -negamax(t, depth - 1, -beta, -alpha, ply + 1);
+    } else {
+      score = -negamax(t, depth - 1 - r, -alpha - 1, -alpha, ply + 1);
+      if (score > alpha && r > 0) {
+        score = -negamax(t, depth - 1, -alpha - 1, -alpha, ply + 1);
+      }
+      if (score > alpha && score < beta) {
+        score = -negamax(t, depth - 1, -beta, -alpha, ply + 1);
+      }
+    }
+    board.unmakeMove();
+
+    if (_stop.load(std::memory_order_relaxed)) {
+      return 0;
+    }
+
+    if (score > best) {
+      best = score;
+      best_move = m;
+      if (score > alpha) {
+        alpha = score;
+
+        t.pv[ply][ply] = m;
+        for (int i = ply + 1; i < t.pv_length[ply + 1]; i++) {
+          t.pv[ply][i] = t.pv[ply + 1][i];
+        }
+        t.pv_length[ply] = t.pv_length[ply + 1];
+
+        if (alpha >= beta) {
+          t.ordering.cutoffs++;
+          if (searched == 0) {
+            t.ordering.first_move_cutoffs++;
+          }
+          if (quiet) {
+            t.ordering.update(board, m, ply, depth, quiets.data(),
+                              quiet_count);
+          }
+          break;
+        }
+      }
+    }
+
+    if (quiet) {
+      quiets[quiet_count++] = m;
+    }
+    searched++;
   }
+
+  const auto bound = best >= beta ? TranspositionTable::LOWER
+                   : best > alpha_start ? TranspositionTable::EXACT
+                   : TranspositionTable::UPPER;
+  _tt.store(board.key(), depth, bound, scoreToTT(best, ply), best_move);
+  return best;
 }
 
 /******************************************************************************
- * Method: AI::evaluate(Move m)
+ *
+ * Method: AI::reduction(const SearchThread&, m, depth, searched, ply, pv)
+ * - how much shallower a late quiet move is searched
+ *****************************************************************************/
+int AI::reduction(const SearchThread& t, PackedMove m, int depth,
+                  int searched, int ply, bool pv_node) const
+{
+  static const auto table = [] {
+    std::array<std::array<int, 64>, 64> r {};
+    for (int d = 1; d < 64; d++) {
+      for (int n = 1; n < 64; n++) {
+        r[d][n] = int(0.75 + std::log(d) * std::log(n) / 2.25);
+      }
+    }
+    return r;
+  }();
+
+  // more the deeper the search and the later the move
+  int r = table[std::min(depth, 63)][std::min(searched, 63)];
+
+  // the killers and counter move are quiet moves that refuted something
+  // close by, they keep more of their depth
+  const auto& ordering = t.ordering;
+  if (m == ordering.killers[ply][0] || m == ordering.killers[ply][1] ||
+      m == ordering.counterMove(t.board))
+  {
+    r--;
+  }
+
+  // and less or more by how the move has done before
+  const auto us = t.board.sideToMove();
+  r -= ordering.history[us][m.from()][m.to()] /
+       (OrderingTables::HISTORY_MAX / 2);
+
+  if (pv_node) {
+    r--;
+  }
+
+  // never straight into quiescence
+  return std::clamp(r, 0, depth - 2);
+}
+
+/******************************************************************************
+ *
+ * Method: AI::quiesce(SearchThread&, alpha, beta, ply)
+ * - captures and promotions past the last ply, every evasion in check
+ *****************************************************************************/
+int AI::quiesce(SearchThread& t, int alpha, int beta, int ply)
+{
+  auto& board = t.board;
+  t.pv_length[ply] = ply;
+
+  if (_stop.load(std::memory_order_relaxed)) {
+    return 0;
+  }
+
+  const auto nodes = t.nodes.load(std::memory_order_relaxed) + 1;
+  t.nodes.store(nodes, std::memory_order_relaxed);
+  if (t.id == 0 && (nodes & 1023) == 0) {
+    checkLimits();
+  }
+
+  if (ply >= MAX_PLY - 1) {
+    return evaluateBoard(board);
+  }
+
+  const auto us = board.sideToMove();
+  const bool in_check = board.isColorInCheck(us);
+
+  // standing pat on the static score, except in check
+  int best = -INF;
+  int stand_pat = -INF;
+  if (!in_check) {
+    stand_pat = evaluateBoard(board);
+    if (stand_pat >= beta) {
+      return stand_pat;
+    }
+
+    // nothing on the board is worth enough to catch up
+    if (stand_pat + pieceValue(QUEEN) + DELTA_MARGIN < alpha) {
+      return stand_pat;
+    }
+
+    best = stand_pat;
+    alpha = std::max(alpha, stand_pat);
+  }
+
+  auto moves = in_check ? board.genLegal(us) : board.genCaptures(us);
+  if (in_check && moves.empty()) {
+    return -MATE + ply;
+  }
+
+  MovePicker picker(board, moves, t.ordering, PackedMove {}, ply);
+  while (const auto m = picker.next()) {
+    if (!in_check && !m.isPromotion()) {
+      const auto victim = m.flag() == PackedMove::EN_PASSANT
+        ? PAWN
+        : board.pieceOn(m.to()).type;
+      // not even the piece taken and a margin on top reach alpha
+      if (stand_pat + pieceValue(victim) + DELTA_MARGIN <= alpha) {
+        continue;
+      }
+
+      // losing the exchange cant be better than standing pat
+      if (board.see(m) < 0) {
+        continue;
+      }
+    }
+
+    board.makeMove(m);
+    const int score = -quiesce(t, -beta, -alpha, ply + 1);
+    board.unmakeMove();
+
+    if (_stop.load(std::memory_order_relaxed)) {
+      return 0;
+    }
+
+    if (score > best) {
+      best = score;
+      if (score > alpha) {
+        alpha = score;
+
+        t.pv[ply][ply] = m;
+        for (int i = ply + 1; i < t.pv_length[ply + 1]; i++) {
+          t.pv[ply][i] = t.pv[ply + 1][i];
+        }
+        t.pv_length[ply] = t.pv_length[ply + 1];
+
+        if (alpha >= beta) {
+          break;
+        }
+      }
+    }
+  }
+  return best;
+}
+
+/******************************************************************************
+ *
+ * Method: AI::scoreToTT(score, ply)
+ *
+ *****************************************************************************/
+int AI::scoreToTT(int score, int ply)
+{
+  if (score >= MATE - MAX_PLY) {
+    return score + ply;
+  }
+  if (score <= -MATE + MAX_PLY) {
+    return score - ply;
+  }
+  return score;
+}
+
+/******************************************************************************
+ *
+ * Method: AI::scoreFromTT(score, ply)
+ *
+ *****************************************************************************/
+int AI::scoreFromTT(int score, int ply)
+{
+  if (score >= MATE - MAX_PLY) {
+    return score - ply;
+  }
+  if (score <= -MATE + MAX_PLY) {
+    return score + ply;
+  }
+  return score;
+}
+
+/******************************************************************************
+ *
+ * Method: AI::hashStats()
+ *
+ *****************************************************************************/
+AI::HashStats AI::hashStats() const
+{
+  HashStats stats { 0, 0, _tt.hashfull() };
+  for (const auto& t : _threads) {
+    stats.probes += t->tt_probes;
+    stats.hits += t->tt_hits;
+  }
+  return stats;
+}
+
+/******************************************************************************
+ *
+ * Method: AI::orderingStats()
+ *
+ *****************************************************************************/
+AI::OrderingStats AI::orderingStats() const
+{
+  OrderingStats stats { 0, 0 };
+  for (const auto& t : _threads) {
+    stats.cutoffs += t->ordering.cutoffs;
+    stats.first_move_cutoffs += t->ordering.first_move_cutoffs;
+  }
+  return stats;
+}
+
+/******************************************************************************
+ *
+ * Method: AI::evaluateBoard(const BoardManager&)
+ * - material and the square tables for the side to move, unless a
+ *   recognizer knows the ending better. The board keeps both sums as it
+ *   goes, this only blends them by the phase
+ *****************************************************************************/
+int AI::evaluateBoard(const BoardManager& board) const
+{
+  const auto known = Endgame::probe(board);
+  if (known.kind != Endgame::Verdict::UNKNOWN) {
+    return known.score;
+  }
+
+  // from white's point of view
+  const int score = Psqt::blend(board.psqt(), board.phase());
+  return board.sideToMove() == WHITE ? score : -score;
+}
+
+/******************************************************************************
+ * Method: AI::evaluate(PackedMove m)
  *
  * returns a score for the given move 
  *****************************************************************************/
-int AI::evaluate(Move m)
+int AI::evaluate(PackedMove m)
 {
   switch (_difficulty) {
     case EASY:
@@ -46,81 +802,74 @@ int AI::evaluate(Move m)
     }
     case MEDIUM:
     {
+      // scratch copy taken by decent_move, the live game may be on screen
+      auto& board = _threads[0]->board;
       // the 'best' move is to take a piece, put the other player
       // in check, and the piece cannot be taken after, OR Checkmate
       int score = 0;
-
-      bool was_attacked = _game->containsPoint(m.from.x, m.from.y,
-                                               _game->genPossibleOpposing(_controlling));
-      auto piece_from = _game->pieceAt(m.from.x, m.from.y);
-      
-      // a copy of the game state, board included
-      BoardManager game_cpy(_game->board_to_fen());
-
-      // below this is the result of 1 move
-      switch ( game_cpy.move(m) ) {
-        case CHECKMATE:
-          return 10000;
-        case INVALID:
-          return -10000;
-        case DRAW:
-          return 0;
-        default:
-          break;
-      }
+      const auto from = toPoint(m.from());
+      const auto to = toPoint(m.to());
 
       auto other_color = _controlling == WHITE ? BLACK : WHITE;
-      auto opponent_moves = game_cpy.genPossibleOpposing(_controlling);
+      bool was_attacked =
+        board.isSquareAttacked(m.from(), other_color);
+      auto piece_from = board.pieceAt(from.x, from.y);
+      auto capture = m.isCapture();
+      int val_capture = getPieceValue(board.pieceAt(to.x, to.y));
+
+      // the piece is safe on its new square if the exchange there
+      // gives nothing back of what it took
+      const int exchange = board.see(m);
+      const bool safe = exchange >= val_capture;
 
-      auto isPieceImmune = [&,&opponent_moves=opponent_moves](int x, int y) {
-        return !game_cpy.containsPoint(x, y, opponent_moves);
-      };
+      // below this is the result of 1 move, played on the main search
+      // thread's copy of the game and taken back before returning. The
+      // real game belongs to the UI thread while the AI is thinking
+      board.makeMove(m);
 
-      if (isCapture(m)) {
-        int val_capture = getPieceValue(_game->pieceAt(m.to.x, m.to.y));
+      if (board.isCheckmate()) {
+        board.unmakeMove();
+        return 10000;
+      }
 
-        if (isPieceImmune(m.to.x, m.to.y)) {
+      if (capture) {
+        if (safe) {
           score += 300;
         }
          
         score += 5 + val_capture;
       }
 
-      if (game_cpy.isColorInCheck(other_color))
+      if (board.isColorInCheck(other_color))
       {
-        // if check and immune, very valuable
-        if (isPieceImmune(m.to.x, m.to.y)) {
+        // if check and safe, very valuable
+        if (safe) {
           score += 50;
         }
         score += 50;
       }
 
-      if (!isPieceImmune(m.to.x, m.to.y)) {
-        score -= getPieceValue(_game->pieceAt(m.from.x, m.from.y));;
+      // what the exchange loses
+      if (!safe) {
+        score += exchange - val_capture;
       }
 
       // If the piece was under attack and a retreating
       // square is available, the move is equal to the
       // pieces value
-      if (was_attacked && isPieceImmune(m.to.x, m.to.y)){
+      if (was_attacked && safe) {
         score += getPieceValue(piece_from);
       }
 
-      // add positional value, if applicable
-      if (piece_from.type == PAWN) {
-        switch (piece_from.Color()) {
-          case WHITE:
-            score += pawn_white_p[m.to.x][m.to.y];
-            break;
-          case BLACK:
-            score += pawn_black_p[m.to.x][m.to.y];
-            break;
-          default:
-            break;
-        }
-      } else if (piece_from.type == KNIGHT) {
-        score += knight_p[m.to.x][m.to.y];
-      }
+      board.unmakeMove();
+
+      // add positional value, what the piece gains on the middlegame
+      // table, and a promotion is worth the piece it becomes
+      const auto type = m.isPromotion() ? m.promotion() : piece_from.type;
+      const int sign = piece_from.color == WHITE ? 1 : -1;
+      score += sign * (Psqt::score(piece_from.color, type, m.to()).mg -
+                       Psqt::score(piece_from.color, piece_from.type,
+                                   m.from()).mg);
 
       return score;
       break;
@@ -142,18 +891,17 @@ int AI::evaluate(Move m)
 
 /******************************************************************************
  *
- * Method: AI::decent_move(vector<Move> possible)
+ * Method: AI::decent_move(const MoveList& possible)
  * - this is a random move from the list of possible moves 
  *****************************************************************************/
-Move AI::decent_move(std::vector<Move> possible)
+PackedMove AI::decent_move(const MoveList& possible)
 {
-  Move move {0,0,0,0};
+  PackedMove move {};
   std::vector<Pair> scores = {};
+  _threads[0]->board = *_game;
   if (_game->colorMatchesTurn(_controlling)) {
     for (auto move : possible) {
-      if (!_game->resultsInCheck(move)) {
-        scores.push_back({evaluate(move) , move});
-      }
+      scores.push_back({evaluate(move) , move});
     }
   }
 
@@ -185,33 +933,9 @@ Move AI::decent_move(std::vector<Move> possible)
  * Method: AI::getPieceValue(Piece p)
  * return the associated integer value for the peice
  *****************************************************************************/
-int AI::getPieceValue(Piece p)
-{
-  switch (p.type) {
-    case PAWN:
-      return 100;
-    case KNIGHT:
-    case BISHOP:
-      return 300;
-    case ROOK:
-      return 500;
-    case QUEEN:
-      return 900;
-    default:
-      return 0;
-  }
-}
-
-/******************************************************************************
- *
- * Method: AI::isCapture(Move m)
- * was the move a capture
- *****************************************************************************/
-bool AI::isCapture(Move m) {
-  auto piece_moving = _game->pieceAt(m.from.x, m.from.y);
-  auto piece_dest = _game->pieceAt(m.to.x, m.to.y);
-
-  return piece_dest && piece_moving.Color() != piece_dest.Color();
+int AI::getPieceValue(Piece p) const
+{
+  return pieceValue(p.type);
 }
 
 /******************************************************************************
@@ -219,7 +943,7 @@ bool AI::isCapture(Move m) {
  * 
  * Pair - Struct with a move and a score
  *****************************************************************************/
-Move AI::getRandMove(const std::vector<Pair>& scores)
+PackedMove AI::getRandMove(const std::vector<Pair>& scores)
 {
   if (scores.size() == 1) {
     return scores[0].move;
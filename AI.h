@@ -1,10 +1,21 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
 #include "common_enums.h"
 #include "BoardManager.h"
+#include "Endgame.h"
+#include "MovePicker.h"
+#include "OpeningBook.h"
+#include "TimeManager.h"
+#include "TranspositionTable.h"
 
 class AI {
   public:
      
-    using Board = std::vector<std::vector<Piece>>;
+    using Board = BoardManager::Board;
 
     enum Difficulty {
       EASY = 0,
@@ -15,66 +26,182 @@ class AI {
 
     struct Pair {
       int score;
-      Move move;
+      PackedMove move;
+    };
+
+    // how far a search may go, a node limit of 0 means no limit
+    struct Limits {
+      int depth;
+      uint64_t nodes;
+    };
+
+    using Clock = TimeManager::Clock;
+
+    static constexpr int INF = 32001;
+    static constexpr int MATE = 32000;
+    static constexpr int MAX_PLY = 64;
+    // what a capture can gain beyond the piece taken, for delta pruning
+    static constexpr int DELTA_MARGIN = 200;
+    // per ply of depth left, how far the static score may be off for
+    // futility pruning and razoring, and the deepest they are tried at
+    static constexpr int FUTILITY_MARGIN = 150;
+    static constexpr int FUTILITY_DEPTH = 3;
+    static constexpr int RAZOR_MARGIN = 300;
+    static constexpr int RAZOR_DEPTH = 2;
+    // a null move cutoff this deep is checked with a normal search first,
+    // 8/8/1p1r1k2/p1pPN1p1/P3KnP1/1P6/8/3R4 b - - is the zugzwang to check
+    // it on, at depth 15 it finds Nxd5 only with the verification
+    static constexpr int NULL_VERIFY_DEPTH = 8;
+
+    // the selective parts of the search, each can be turned off on its own
+    // to compare node counts and strength without it
+    struct Pruning {
+      bool null_move = true;
+      bool late_move_reductions = true;
+      bool futility = true;
+      bool razoring = true;
+    };
+
+    // transposition table use over the last search
+    struct HashStats {
+      uint64_t probes;
+      uint64_t hits;
+      // permille of the table written by the last search
+      int hashfull;
+
+      double hitRate() const { return probes ? double(hits) / probes : 0.0; }
+    };
+
+    // beta cutoffs over the last search and how many came from the
+    // first move searched, the higher the better the ordering
+    struct OrderingStats {
+      uint64_t cutoffs;
+      uint64_t first_move_cutoffs;
+
+      double firstMoveRate() const {
+        return cutoffs ? double(first_move_cutoffs) / cutoffs : 0.0;
+      }
     };
 
-    AI(Color c, Difficulty d, BoardManager* game);
+    // with more than one thread the extra threads search the same position
+    // alongside the main one and only help through the shared table
+    AI(Color c, Difficulty d, BoardManager* game, size_t hash_mb = 16,
+       int threads = 1);
+
+    PackedMove move();
+
+    // the searching difficulties play within the clock instead of their
+    // node budget, the depth limit still holds
+    PackedMove move(const Clock& clock);
+
+    // safe from any thread, the search returns its best move so far
+    void stop() { _stop = true; }
 
-    Move move();
+    // the reply the last search expected to its move, null if it had none
+    PackedMove ponderMove() const { return _ponder_move; }
 
-    int getPieceValue(Piece p);
+    // sets up a search of the position after ponderMove() has been played
+    // on the game. Done on the calling thread so a stop() that follows
+    // straight after is not lost. False when there is nothing to ponder
+    bool startPonder(const Clock& clock);
+
+    // runs the search startPonder() set up with no limit but the depth.
+    // After ponderhit() it goes on as move(clock) would, with the time
+    // spent pondering already counted against the budget. Stopped before
+    // a ponderhit it returns a null move
+    PackedMove ponder();
+
+    // the opponent played ponderMove(), safe from any thread
+    void ponderhit();
+
+    // replaces the budget the difficulty picked
+    void setLimits(const Limits& limits) { _limits = limits; }
+
+    // not while a search is running
+    void setPruning(const Pruning& pruning) { _pruning = pruning; }
+    const Pruning& pruning() const { return _pruning; }
+
+    // the searching difficulties play straight from the book while it has
+    // the position, false if the file could not be opened
+    bool loadBook(const std::string& path) { return _book.open(path); }
+
+    // every finished depth's score and line, the table and ordering
+    // figures after each search, book moves and what is pondered on go
+    // to stdout. Off by default
+    void setVerbose(bool verbose) { _verbose = verbose; }
+
+    void resizeHash(size_t mb) { _tt.resize(mb); }
+    HashStats hashStats() const;
+    OrderingStats orderingStats() const;
+
+    int getPieceValue(Piece p) const;
 
   private:
     Color _controlling;
     BoardManager* const _game;
     Difficulty _difficulty;
+    Limits _limits;
+    Pruning _pruning;
+    bool _verbose = false;
+    TranspositionTable _tt;
+    OpeningBook _book;
 
-    Move decent_move(std::vector<Move> possible);
-    bool isCapture(Move m);
-    int evaluate(Move m);
-    Move getRandMove(const std::vector<Pair>& pairs);
-
-    const int pawn_white_p[8][8] = {
-      {900, 900, 900, 900, 900, 900, 900, 900},
-      {50, 50, 50, 50, 50, 50, 50, 50},
-      {10, 10, 20, 30, 30, 20, 10, 10},
-      {5,  5, 10, 25, 25, 10,  5,  5},
-      {0,  0,  0, 20, 20,  0,  0,  0},
-      {5, -5,-10,  0,  0,-10, -5,  5},
-      {5, 10, 10,-20,-20, 10, 10,  5},
-      {0,  0,  0,  0,  0,  0,  0,  0}
-    };
+    // everything one search thread owns, each plays its moves on its
+    // own copy of the game and only the table is shared
+    struct SearchThread {
+      int id = 0;
+      BoardManager board;
+      // only written by the owner, read by the main thread for the limit
+      std::atomic<uint64_t> nodes {0};
+      uint64_t tt_probes = 0;
+      uint64_t tt_hits = 0;
+      PackedMove root_best {};
+      // the reply root_best's line expects
+      PackedMove root_ponder {};
+      OrderingTables ordering;
+      // no null moves above this ply, set while a null move cutoff is
+      // being verified
+      int null_min_ply = 0;
 
-    const int pawn_black_p[8][8] = {
-      {0,  0,  0,  0,  0,  0,  0,  0},
-      {5, 10, 10,-20,-20, 10, 10,  5},
-      {5, -5,-10,  0,  0,-10, -5,  5},
-      {0,  0,  0, 20, 20,  0,  0,  0},
-      {5,  5, 10, 25, 25, 10,  5,  5},
-      {10, 10, 20, 30, 30, 20, 10, 10},
-      {50, 50, 50, 50, 50, 50, 50, 50},
-      {900, 900, 900, 900, 900, 900, 900, 900}
+      // triangular principal variation, row ply holds the best line
+      // found from that ply on
+      std::array<std::array<PackedMove, MAX_PLY>, MAX_PLY> pv {};
+      std::array<int, MAX_PLY> pv_length {};
     };
 
-    const int knight_p[8][8] = {
-      {-50,-40,-30,-30,-30,-30,-40,-50},
-      {-40,-20,  0,  0,  0,  0,-20,-40},
-      {-30,  0, 10, 15, 15, 10,  0,-30},
-      {-30,  5, 15, 20, 20, 15,  5,-30},
-      {-30,  0, 15, 20, 20, 15,  0,-30},
-      {-30,  5, 10, 15, 15, 10,  5,-30},
-      {-40,-20,  0,  5,  5,  0,-20,-40},
-      {-50,-40,-30,-30,-30,-30,-40,-50}
-    };
+    // the main thread is first
+    std::vector<std::unique_ptr<SearchThread>> _threads;
+    std::atomic<bool> _stop {false};
+    TimeManager _time;
+    // the limits of the search that is running
+    Limits _running;
 
-    const int bishop_white_p[8][8] = {
-      {-20,-10,-10,-10,-10,-10,-10,-20},
-      {-10,  0,  0,  0,  0,  0,  0,-10},
-      {-10,  0,  5, 10, 10,  5,  0,-10},
-      {-10,  5,  5, 10, 10,  5,  5,-10},
-      {-10,  0, 10, 10, 10, 10,  0,-10},
-      {-10, 10, 10, 10, 10, 10, 10,-10},
-      {-10,  5,  0,  0,  0,  0,  5,-10},
-      {-20,-10,-10,-10,-10,-10,-10,-20}
-    };
+    // set while searching on the opponent's time, the budget is not
+    // enforced until it is cleared by a ponderhit
+    std::atomic<bool> _pondering {false};
+    // the budget ran out while pondering, the ponderhit stops the search
+    std::atomic<bool> _stop_on_ponderhit {false};
+    PackedMove _ponder_move {};
+    BoardManager _ponder_root;
+
+    static Limits limitsFor(Difficulty d);
+
+    PackedMove bookMove();
+    PackedMove search(const BoardManager& root, const Limits& limits);
+    void iterate(SearchThread& t);
+    int negamax(SearchThread& t, int depth, int alpha, int beta, int ply);
+    int reduction(const SearchThread& t, PackedMove m, int depth,
+                  int searched, int ply, bool pv_node) const;
+    int quiesce(SearchThread& t, int alpha, int beta, int ply);
+    void checkLimits();
+    uint64_t totalNodes() const;
+    int evaluateBoard(const BoardManager& board) const;
+
+    // mate scores are stored as distance from the position, not the root
+    static int scoreToTT(int score, int ply);
+    static int scoreFromTT(int score, int ply);
+
+    PackedMove decent_move(const MoveList& possible);
+    int evaluate(PackedMove m);
+    PackedMove getRandMove(const std::vector<Pair>& pairs);
 };
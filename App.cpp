@@ -18,10 +18,12 @@ App::App()
               SDL_WINDOWPOS_CENTERED,
               _screenW,
               _screenH,
-              SDL_WINDOW_SHOWN);
+              SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
 
 
   _renderer = SDL_CreateRenderer(_window, -1, SDL_RENDERER_ACCELERATED);
+  // draw and read clicks in board coordinates whatever size the window is
+  SDL_RenderSetLogicalSize(_renderer, _screenW, _screenH);
   auto* surface = IMG_Load("resources/circle.png");
 
   if (surface) {
@@ -38,21 +40,32 @@ App::App()
   _win_sound = Mix_LoadWAV("resources/game_win.wav");
   _lose_sound = Mix_LoadWAV("resources/game_lose.wav");
 
-  p_textures.insert({"resources/pawn_white.png", loadTexture("resources/pawn_white.png") });
-  p_textures.insert({"resources/pawn_black.png", loadTexture("resources/pawn_black.png") });
-  p_textures.insert({"resources/king_white.png", loadTexture("resources/king_white.png") });
-  p_textures.insert({"resources/king_black.png", loadTexture("resources/king_black.png") });
-  p_textures.insert({"resources/queen_white.png", loadTexture("resources/queen_white.png") });
-  p_textures.insert({"resources/queen_black.png", loadTexture("resources/queen_black.png") });
-  p_textures.insert({"resources/rook_white.png", loadTexture("resources/rook_white.png") });
-  p_textures.insert({"resources/rook_black.png", loadTexture("resources/rook_black.png") });
-  p_textures.insert({"resources/bishop_white.png", loadTexture("resources/bishop_white.png") });
-  p_textures.insert({"resources/bishop_black.png", loadTexture("resources/bishop_black.png") });
-  p_textures.insert({"resources/knight_white.png", loadTexture("resources/knight_white.png") });
-  p_textures.insert({"resources/knight_black.png", loadTexture("resources/knight_black.png") });
+  // texture paths in the same order as the piece bitboards
+  static constexpr const char* piece_paths[12] = {
+    "resources/pawn_white.png",
+    "resources/knight_white.png",
+    "resources/bishop_white.png",
+    "resources/rook_white.png",
+    "resources/queen_white.png",
+    "resources/king_white.png",
+    "resources/pawn_black.png",
+    "resources/knight_black.png",
+    "resources/bishop_black.png",
+    "resources/rook_black.png",
+    "resources/queen_black.png",
+    "resources/king_black.png"
+  };
+
+  for (int i = 0; i < 12; i++) {
+    _piece_textures[i] = loadTexture(piece_paths[i]);
+  }
 
   _game = new BoardManager();
   _ai = new AI(Color::BLACK, AI::MEDIUM, _game);
+  if (!_ai->loadBook("resources/book.bin")) {
+    std::cout << "no opening book, the AI will search from the first move\n";
+  }
+  _ai_event = SDL_RegisterEvents(1);
 }
 
 /******************************************************************************
@@ -62,8 +75,8 @@ App::App()
  *****************************************************************************/
 void App::run()
 {
-  // cached piece that has been previously clicked
-  std::optional<Piece> clicked;
+  // square of the piece that has been previously clicked
+  std::optional<Point> clicked;
   // is_first_frame
   bool first = true;
 
@@ -71,6 +84,7 @@ void App::run()
 
   auto game_over = [&](auto sound) {
   // check for checkmate
+    stopPonder();
     Mix_PlayChannel(1, sound, 0);
     SDL_Delay(2000);
     first = true;
@@ -103,6 +117,11 @@ void App::run()
         std::cout << "Draw \n";
         break;
 
+      case MoveResult::STALEMATE:
+        game_over(_lose_sound);
+        std::cout << "Stalemate \n";
+        break;
+
       default:
         std::cout << "something went wrong \n";
         break;
@@ -124,13 +143,37 @@ void App::run()
     
     SDL_WaitEvent(&ev);
 
+    // the AI finished thinking, play its move and think on the reply
+    if (ev.type == _ai_event) {
+      stopAI();
+      if (handle_move(PackedMove::fromRaw(ev.user.code)) == MoveResult::VALID) {
+        startPonder();
+      }
+      continue;
+    }
+
     switch (ev.type) {
       case SDL_QUIT:
         _state = AppState::EXIT;
         break;
 
+      case SDL_WINDOWEVENT:
+      {
+        if (ev.window.event == SDL_WINDOWEVENT_EXPOSED
+            || ev.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+        {
+          display();
+        }
+        break;
+      }
+
       case SDL_MOUSEBUTTONDOWN:
       {
+        // the board is not ours to touch until the AI has moved
+        if (_ai_thinking) {
+          break;
+        }
+
         display();
         auto x = ev.button.x;
         auto y = ev.button.y;
@@ -143,27 +186,26 @@ void App::run()
           if (auto this_piece = _game->pieceAt(grid_y, grid_x);
               this_piece)
           { 
-            if (_game->colorMatchesTurn(this_piece.Color()))
+            if (_game->colorMatchesTurn(this_piece.color))
             {
-              clicked = this_piece;
-              _possible_moves = _game->genPossible(this_piece);
+              clicked = Point {grid_y, grid_x};
+              _possible_moves = _game->genPossible(clicked.value());
               displayPossible();
             }
           }
 
         } else {
 
-          if (_game->colorMatchesTurn(clicked.value().Color()))
+          auto from = clicked.value();
+          if (_game->colorMatchesTurn(_game->pieceAt(from.x, from.y).color))
           {
-            Move m = { Point {clicked.value().x, clicked.value().y },
-                              Point {grid_y, grid_x} };
+            Move m = { from, Point {grid_y, grid_x} };
 
             // if the move took place
             auto result = handle_move(m);
 
             if (result == MoveResult::VALID) {
-              SDL_Delay(750);
-              handle_move(_ai->move());
+              replyTo(_game->lastMove());
             } 
 
 
@@ -213,6 +255,108 @@ void App::run()
         break;
     }
   }
+
+  // don't leave the AI searching a board that is about to be deleted
+  _ai->stop();
+  stopAI();
+  _ai_pondering = false;
+}
+
+/******************************************************************************
+ *
+ * Method: App::startAI()
+ *
+ * - ask the AI for a move on a worker thread, the answer comes back through
+ *   the event queue as an _ai_event carrying the packed move
+ *****************************************************************************/
+void App::startAI()
+{
+  _ai_thinking = true;
+  _ai_thread = std::thread([this] {
+    auto move = _ai->move(AI::Clock { .move_time = _ai_move_ms });
+
+    SDL_Event ev {};
+    ev.type = _ai_event;
+    ev.user.code = move.raw();
+    SDL_PushEvent(&ev);
+  });
+}
+
+/******************************************************************************
+ *
+ * Method: App::stopAI()
+ *
+ * - wait for the worker thread, call AI::stop() first to cut it short
+ *****************************************************************************/
+void App::stopAI()
+{
+  if (_ai_thread.joinable()) {
+    _ai_thread.join();
+  }
+  _ai_thinking = false;
+}
+
+/******************************************************************************
+ *
+ * Method: App::startPonder()
+ *
+ * - search the reply the AI expects while the player thinks, the result is
+ *   only posted if that reply is the one played
+ *****************************************************************************/
+void App::startPonder()
+{
+  if (!_ai->startPonder(AI::Clock { .move_time = _ai_move_ms })) {
+    return;
+  }
+
+  _ai_pondering = true;
+  _ai_thread = std::thread([this] {
+    auto move = _ai->ponder();
+    if (!move) {
+      return;
+    }
+
+    SDL_Event ev {};
+    ev.type = _ai_event;
+    ev.user.code = move.raw();
+    SDL_PushEvent(&ev);
+  });
+}
+
+/******************************************************************************
+ *
+ * Method: App::stopPonder()
+ *
+ *****************************************************************************/
+void App::stopPonder()
+{
+  if (!_ai_pondering) {
+    return;
+  }
+
+  _ai->stop();
+  stopAI();
+  _ai_pondering = false;
+}
+
+/******************************************************************************
+ *
+ * Method: App::replyTo(PackedMove)
+ *
+ * - the player has moved, a ponderhit lets the search already running
+ *   carry on, otherwise it is thrown away and a new one started
+ *****************************************************************************/
+void App::replyTo(PackedMove played)
+{
+  if (_ai_pondering && played == _ai->ponderMove()) {
+    _ai->ponderhit();
+    _ai_pondering = false;
+    _ai_thinking = true;
+    return;
+  }
+
+  stopPonder();
+  startAI();
 }
 
 /******************************************************************************
@@ -244,7 +388,7 @@ void App::renderAllPieces() {
       if (auto piece = _game->pieceAt(i, j);
           piece)
       {
-        renderPiece(p_textures.at(piece.Icon()), piece);
+        renderPiece(textureFor(piece), i, j);
       }
     }
    }
@@ -263,10 +407,10 @@ void App::displayBoard(const Board& board)
   // render all peices
   for (int i = 0; i < 8; i++) {
     for (int j = 0; j < 8; j++) {
-      if (auto piece = board[i][j];
+      if (auto piece = board[toSquare(i, j)];
           piece)
       {
-        renderPiece(p_textures.at(piece.Icon()), piece);
+        renderPiece(textureFor(piece), i, j);
       }
     }
    }
@@ -289,8 +433,7 @@ void App::displayPossible()
  SDL_Rect src = {0,0, 30, 30};
  
  for (auto move : _possible_moves) {
-    auto x = move.to.x;
-    auto y = move.to.y;
+    auto [x, y] = toPoint(move.to());
 
     SDL_Rect dest = {
               _screenW / 8 * y + 30,
@@ -336,12 +479,12 @@ void App::renderBackground()
  * Method: App::renderPiece()
  *
  *****************************************************************************/
-void App::renderPiece(SDL_Texture *texture, Piece p)
+void App::renderPiece(SDL_Texture *texture, int x, int y)
 {
   SDL_Rect src = {0, 0, 80, 80};
 	SDL_Rect dest = { 
-                    _screenW / 8 * p.y + 5,
-					          _screenH / 8 * p.x + 5,
+                    _screenW / 8 * y + 5,
+					          _screenH / 8 * x + 5,
 					          _screenW / 8 - 10,
 					          _screenH / 8 - 10};
   SDL_RenderCopy(_renderer, texture, &src, &dest);
@@ -1,6 +1,7 @@
 #pragma once
 
-#include <map>
+#include <array>
+#include <thread>
 #include "common_enums.h"
 #include "SDL.h"
 #include "SDL_image.h"
@@ -18,6 +19,8 @@ class App {
   private:
     const int _screenW = 720;
     const int _screenH = 720;
+    // how long the AI may think about each move
+    const int64_t _ai_move_ms = 1000;
 
     SDL_Window* _window;
     SDL_Renderer* _renderer;
@@ -25,9 +28,10 @@ class App {
     Mix_Chunk* _move_sound;
     Mix_Chunk* _win_sound;
     Mix_Chunk* _lose_sound;
-    std::map<std::string, SDL_Texture*> p_textures;
+    // one texture per color and piece type, indexed like the bitboards
+    std::array<SDL_Texture*, 12> _piece_textures;
 
-    std::vector<Move> _possible_moves;
+    MoveList _possible_moves;
 
     enum AppState {
       PLAY = 0,
@@ -39,14 +43,32 @@ class App {
     BoardManager* _game;
     AI* _ai;
 
-    using Board = std::vector<std::vector<Piece>>;
+    // the AI thinks on its own thread and posts its move back as an
+    // _ai_event so the window keeps drawing and answering meanwhile
+    Uint32 _ai_event;
+    std::thread _ai_thread;
+    bool _ai_thinking = false;
+    // between the AI's move and the reply it is searching the reply it
+    // expects on the same thread, see startPonder()
+    bool _ai_pondering = false;
+
+    using Board = BoardManager::Board;
 
     SDL_Texture* loadTexture(const char* filepath);
+    SDL_Texture* textureFor(Piece p) const {
+      return _piece_textures[p.color * 6 + p.type - 1];
+    }
+
+    void startAI();
+    void stopAI();
+    void startPonder();
+    void stopPonder();
+    void replyTo(PackedMove played);
 
     void display();
     void displayBoard(const Board& p);
     void displayPossible();
     void renderBackground();
-    void renderPiece(SDL_Texture* txture, Piece p);
+    void renderPiece(SDL_Texture* txture, int x, int y);
     void renderAllPieces();
 };
@@ -0,0 +1,141 @@
+#include "Bitboard.h"
+#include <initializer_list>
+
+namespace Bitboards {
+  Magic rookMagics[64];
+  Magic bishopMagics[64];
+  Bitboard betweenBB[64][64];
+  Bitboard lineBB[64][64];
+}
+
+namespace {
+
+  // every blocker configuration for every square, 102400 for rooks
+  // and 5248 for bishops with the shifts produced by the mask sizes
+  Bitboard rookTable[0x19000];
+  Bitboard bishopTable[0x1480];
+
+  const int rookDirs[4][2] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+  const int bishopDirs[4][2] = { {1, 1}, {-1, -1}, {-1, 1}, {1, -1} };
+
+  /****************************************************************************
+   *
+   * Function: slidingAttacks(Square, dirs, Bitboard)
+   * - walks each ray until it hits a blocker, the blocker is included.
+   *   only used to fill the tables
+   ***************************************************************************/
+  Bitboard slidingAttacks(Square s, const int dirs[4][2], Bitboard occupied)
+  {
+    Bitboard attacks = 0;
+    for (int d = 0; d < 4; d++) {
+      int x = (s >> 3) + dirs[d][0];
+      int y = (s & 7) + dirs[d][1];
+      while (x >= 0 && x < 8 && y >= 0 && y < 8) {
+        attacks |= squareBB(toSquare(x, y));
+        if (occupied & squareBB(toSquare(x, y))) {
+          break;
+        }
+        x += dirs[d][0];
+        y += dirs[d][1];
+      }
+    }
+    return attacks;
+  }
+
+  /****************************************************************************
+   *
+   * Function: sparseRandom(uint64_t&)
+   * - xorshift64*, and'ed together to get the few set bits good magics need
+   ***************************************************************************/
+  uint64_t sparseRandom(uint64_t& state)
+  {
+    auto next = [&state] {
+      state ^= state >> 12;
+      state ^= state << 25;
+      state ^= state >> 27;
+      return state * 2685821657736338717ULL;
+    };
+    return next() & next() & next();
+  }
+
+  /****************************************************************************
+   *
+   * Function: initMagics(table, magics, dirs)
+   * - finds a collision free magic for every square by trial and error,
+   *   the seed is fixed so the tables are the same on every run
+   ***************************************************************************/
+  void initMagics(Bitboard* table, Magic magics[64], const int dirs[4][2])
+  {
+    Bitboard occupancy[4096];
+    Bitboard reference[4096];
+    int epoch[4096] = {};
+    int attempt = 0;
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+
+    for (Square s = 0; s < 64; s++) {
+      // the edges never change the attack set unless the piece is on them
+      const Bitboard edges =
+        ((RANK_1 | RANK_8) & ~(RANK_8 << (s & ~7))) |
+        ((FILE_A | FILE_H) & ~(FILE_A << (s & 7)));
+
+      auto& m = magics[s];
+      m.mask = slidingAttacks(s, dirs, 0) & ~edges;
+      m.shift = 64 - popCount(m.mask);
+      m.attacks = s == 0 ? table : magics[s - 1].attacks + (1 << (64 - magics[s - 1].shift));
+
+      // enumerate every subset of the mask (carry rippler)
+      int size = 0;
+      Bitboard b = 0;
+      do {
+        occupancy[size] = b;
+        reference[size] = slidingAttacks(s, dirs, b);
+        size++;
+        b = (b - m.mask) & m.mask;
+      } while (b);
+
+      for (int i = 0; i < size;) {
+        do {
+          m.magic = sparseRandom(seed);
+        } while (popCount((m.magic * m.mask) >> 56) < 6);
+
+        attempt++;
+        for (i = 0; i < size; i++) {
+          auto idx = m.index(occupancy[i]);
+          if (epoch[idx] < attempt) {
+            epoch[idx] = attempt;
+            m.attacks[idx] = reference[i];
+          } else if (m.attacks[idx] != reference[i]) {
+            break;
+          }
+        }
+      }
+    }
+  }
+}
+
+/******************************************************************************
+ *
+ * Function: Bitboards::init()
+ *
+ *****************************************************************************/
+void Bitboards::init()
+{
+  static const bool initialised = [] {
+    initMagics(rookTable, rookMagics, rookDirs);
+    initMagics(bishopTable, bishopMagics, bishopDirs);
+
+    for (Square a = 0; a < 64; a++) {
+      for (Square b = 0; b < 64; b++) {
+        for (auto attacks : { rookAttacks, bishopAttacks }) {
+          if (a != b && (attacks(a, 0) & squareBB(b))) {
+            betweenBB[a][b] = attacks(a, squareBB(b)) & attacks(b, squareBB(a));
+            lineBB[a][b] = (attacks(a, 0) & attacks(b, 0)) |
+                           squareBB(a) | squareBB(b);
+          }
+        }
+      }
+    }
+    return true;
+  }();
+  (void)initialised;
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include "common_enums.h"
+
+// one bit per square, squares are numbered the same way as the board grid,
+// row major from the top left, so a8 = 0, h8 = 7, a1 = 56 and h1 = 63
+using Bitboard = uint64_t;
+using Square = int;
+
+constexpr Square NO_SQUARE = -1;
+
+constexpr Bitboard FILE_A = 0x0101010101010101ULL;
+constexpr Bitboard FILE_H = FILE_A << 7;
+
+// rank 8 is row 0 of the grid, rank 1 is row 7
+constexpr Bitboard RANK_8 = 0xFFULL;
+constexpr Bitboard RANK_7 = RANK_8 << 8;
+constexpr Bitboard RANK_3 = RANK_8 << 40;
+constexpr Bitboard RANK_6 = RANK_8 << 16;
+constexpr Bitboard RANK_2 = RANK_8 << 48;
+constexpr Bitboard RANK_1 = RANK_8 << 56;
+
+constexpr Square toSquare(int x, int y) { return x * 8 + y; }
+constexpr Point toPoint(Square s) { return Point { s >> 3, s & 7 }; }
+constexpr Bitboard squareBB(Square s) { return 1ULL << s; }
+
+constexpr Color opposite(Color c) { return c == WHITE ? BLACK : WHITE; }
+
+inline int popCount(Bitboard b) { return std::popcount(b); }
+inline Square lsb(Bitboard b) { return std::countr_zero(b); }
+
+// returns the least significant square and removes it from the bitboard
+inline Square popLsb(Bitboard& b)
+{
+  Square s = lsb(b);
+  b &= b - 1;
+  return s;
+}
+
+// single step shifts, "north" is towards rank 8 (row 0)
+constexpr Bitboard north(Bitboard b) { return b >> 8; }
+constexpr Bitboard south(Bitboard b) { return b << 8; }
+constexpr Bitboard east(Bitboard b) { return (b << 1) & ~FILE_A; }
+constexpr Bitboard west(Bitboard b) { return (b >> 1) & ~FILE_H; }
+
+// one step towards the other side of the board for that color's pawns
+template<Color Us>
+constexpr Bitboard forward(Bitboard b)
+{
+  return Us == WHITE ? north(b) : south(b);
+}
+
+// every square attacked by any of the pieces in b, used to
+// build the tables below and for pawns in bulk
+constexpr Bitboard pawnAttacksBB(Color c, Bitboard b)
+{
+  return c == WHITE ? east(north(b)) | west(north(b))
+                    : east(south(b)) | west(south(b));
+}
+
+constexpr Bitboard knightAttacksBB(Bitboard b)
+{
+  Bitboard l1 = (b >> 1) & ~FILE_H;
+  Bitboard l2 = (b >> 2) & ~(FILE_H | (FILE_H >> 1));
+  Bitboard r1 = (b << 1) & ~FILE_A;
+  Bitboard r2 = (b << 2) & ~(FILE_A | (FILE_A << 1));
+  Bitboard h1 = l1 | r1;
+  Bitboard h2 = l2 | r2;
+  return (h1 << 16) | (h1 >> 16) | (h2 << 8) | (h2 >> 8);
+}
+
+constexpr Bitboard kingAttacksBB(Bitboard b)
+{
+  Bitboard row = b | east(b) | west(b);
+  return (row | north(row) | south(row)) & ~b;
+}
+
+// leaper attacks by square, built at compile time
+namespace Bitboards {
+  template<typename F>
+  constexpr std::array<Bitboard, 64> leaperTable(F attacks)
+  {
+    std::array<Bitboard, 64> table {};
+    for (Square s = 0; s < 64; s++) {
+      table[s] = attacks(squareBB(s));
+    }
+    return table;
+  }
+
+  inline constexpr auto knightTable = leaperTable(knightAttacksBB);
+  inline constexpr auto kingTable = leaperTable(kingAttacksBB);
+  inline constexpr std::array<Bitboard, 64> pawnTable[2] = {
+    leaperTable([](Bitboard b) { return pawnAttacksBB(WHITE, b); }),
+    leaperTable([](Bitboard b) { return pawnAttacksBB(BLACK, b); })
+  };
+}
+
+constexpr Bitboard pawnAttacks(Color c, Square s) { return Bitboards::pawnTable[c][s]; }
+constexpr Bitboard knightAttacks(Square s) { return Bitboards::knightTable[s]; }
+constexpr Bitboard kingAttacks(Square s) { return Bitboards::kingTable[s]; }
+
+// magic bitboard lookup for sliding pieces, the relevant occupancy of a
+// square is multiplied by the magic number and the top bits index into
+// a table of precomputed attack sets
+struct Magic {
+  Bitboard mask = 0;
+  Bitboard magic = 0;
+  Bitboard* attacks = nullptr;
+  unsigned shift = 0;
+
+  unsigned index(Bitboard occupied) const {
+    return unsigned(((occupied & mask) * magic) >> shift);
+  }
+};
+
+namespace Bitboards {
+  // builds the slider tables, safe to call more than once
+  void init();
+
+  extern Magic rookMagics[64];
+  extern Magic bishopMagics[64];
+
+  // squares strictly between two squares on a shared rank, file or
+  // diagonal, and the whole line through them, both empty otherwise
+  extern Bitboard betweenBB[64][64];
+  extern Bitboard lineBB[64][64];
+}
+
+inline Bitboard between(Square a, Square b) { return Bitboards::betweenBB[a][b]; }
+inline Bitboard line(Square a, Square b) { return Bitboards::lineBB[a][b]; }
+
+inline Bitboard rookAttacks(Square s, Bitboard occupied)
+{
+  const auto& m = Bitboards::rookMagics[s];
+  return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard bishopAttacks(Square s, Bitboard occupied)
+{
+  const auto& m = Bitboards::bishopMagics[s];
+  return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard queenAttacks(Square s, Bitboard occupied)
+{
+  return rookAttacks(s, occupied) | bishopAttacks(s, occupied);
+}
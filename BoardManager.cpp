@@ -1,4 +1,5 @@
 #include "BoardManager.h"
+#include <algorithm>
 #include <sstream>
 #include <string>
 #include <assert.h>
@@ -10,7 +11,8 @@
  *****************************************************************************/
 BoardManager::BoardManager()
 {
-  _board = std::vector<std::vector<Piece>>(8, std::vector<Piece>(8, Piece()));
+  Bitboards::init();
+  _undo_stack.reserve(256);
   initBoard();
 }
 
@@ -21,7 +23,8 @@ BoardManager::BoardManager()
  *****************************************************************************/
 BoardManager::BoardManager(std::string fen)
 {
-  _board = std::vector<std::vector<Piece>>(8, std::vector<Piece>(8, Piece()));
+  Bitboards::init();
+  _undo_stack.reserve(256);
   fen_to_state(fen);
 }
 
@@ -40,9 +43,20 @@ void BoardManager::reset()
  * Method: BoardManager::genPossible()
  * - returns the possible moves for this piece
  *****************************************************************************/
-std::vector<Move> BoardManager::genPossible(Piece p)
+MoveList BoardManager::genPossible(Point p)
 {
-  return GPM_Piece(p);
+  MoveList possible;
+  if (!validPoint(p.x, p.y)) {
+    return possible;
+  }
+
+  const auto from = toSquare(p.x, p.y);
+  for (auto m : genLegal(colorAt(from))) {
+    if (m.from() == from) {
+      possible.push_back(m);
+    }
+  }
+  return possible;
 }
 
 /******************************************************************************
@@ -51,160 +65,296 @@ std::vector<Move> BoardManager::genPossible(Piece p)
  *****************************************************************************/
 MoveResult BoardManager::move(Move m)
 {
-  auto possible_moves = genPossible(pieceAt(m.from.x, m.from.y));
-
-  if (containsPoint(m.to.x, m.to.y, possible_moves) &&
-      !resultsInCheck(m))
-  {
-    auto result = do_move(m);
-
-    if (result == MoveType::ENABLE_PASSANT) {
-      _en_passant_enabled = true;
-      auto mod = _isWhiteTurn ? -1 : 1;
-      _passant_target = Point{m.to.x - mod, m.to.y};
-    } else if (result == MoveType::PERFORM_PASSANT && _en_passant_enabled) {
-      _en_passant_enabled = false;
-      _passant_target = Point {-1, -1};
-      // do the actual logic to clear the piece we took
-    } else {
-      _en_passant_enabled = false;
-      _passant_target = Point {-1, -1};
-    }
-    
-    // black is moving, increment the full move count
-    if (!_isWhiteTurn) {
-      _move_count++;
-    }
+  return move(findMove(m));
+}
 
-    _isWhiteTurn = !_isWhiteTurn;
+/******************************************************************************
+ * PUBLIC
+ * Method: BoardManager::move(PackedMove m)
+ *****************************************************************************/
+MoveResult BoardManager::move(PackedMove m)
+{
+  const auto legal = genLegal(_side_to_move);
+  const bool is_legal =
+    m && std::find(legal.begin(), legal.end(), m) != legal.end();
 
-    _half_move_count++;
+  if (is_legal) {
+    makeMove(m);
     
     _history.push_back(board_to_fen());
 
-    if (_history.size() >= 3) {
-      auto count = 0;
-      auto last = _history[_history.size() - 1]; 
-      for (int i = 0; i < _history.size() - 2; i++) {
-        if (_history[i].compare(last) == 0) {
-          count++;
-        }
-      }
-      // 3 move repetition draw
-      if (count >= 3) {
-        return MoveResult::DRAW;
-      }
+    if (genLegal(_side_to_move).empty()) {
+      return isColorInCheck(_side_to_move) ? MoveResult::CHECKMATE
+                                           : MoveResult::STALEMATE;
     }
-    
-    return isCheckmate() ? MoveResult::CHECKMATE : MoveResult::VALID;
+
+    // 3 move repetition or 50 moves without a capture or pawn move
+    if (repetitions() >= 2 || _halfmove_clock >= 100) {
+      return MoveResult::DRAW;
+    }
+
+    return MoveResult::VALID;
   }
   // something other than 3 move repetition, checkmate or a valid move
   return MoveResult::INVALID;
 }
 
 /******************************************************************************
+ * PUBLIC
+ * Method: BoardManager::findMove(Move m)
  *
- * Method: BoardManager::do_move(Move, Board)
- * 
- * - performs the move and returns the type of move
+ * - the UI doesnt ask which piece to promote to, so it gets a queen
  *****************************************************************************/
-BoardManager::MoveType BoardManager::do_move(Move m)
+PackedMove BoardManager::findMove(Move m)
 {
-  auto from_x = m.from.x;
-  auto from_y = m.from.y;
-  auto to_x = m.to.x;
-  auto to_y = m.to.y;
-
-  auto dx = abs(to_x - from_x);
-  auto dy = abs(to_y - from_y);
-  bool is_castle = dy == 2 && _board[from_x][from_y].type == KING;
-  auto mod = _board[from_x][from_y].color == WHITE ? 1 : -1;
-  auto dest_piece_present = _board[to_x][to_y].type != NONE;
-
-  // move contsructor?
-  _board[to_x][to_y].prev_x = from_x;
-  _board[to_x][to_y].prev_y = from_y;
-  _board[to_x][to_y].x = to_x;
-  _board[to_x][to_y].y = to_y;
-  _board[to_x][to_y].type = _board[from_x][from_y].type;
-  _board[to_x][to_y].color = _board[from_x][from_y].color;
-  _board[to_x][to_y].icon = _board[from_x][from_y].icon;
-  _board[to_x][to_y].has_moved = true;
-  _board[from_x][from_y].Clear();
-  
-  // auto promote to queen
-  if (_board[to_x][to_y].type == PAWN &&
-      (to_x == 0 || to_x == 7))
-  {
-    _board[to_x][to_y].type = QUEEN;
-    _board[to_x][to_y].icon = "resources/queen_" +
-                             _board[to_x][to_y].colorToString() +
-                             ".png";
+  if (!validPoint(m.from.x, m.from.y) || !validPoint(m.to.x, m.to.y)) {
+    return PackedMove {};
   }
 
-  // en passant move, if the piece is a pawn and the difference in x and y is 1
-  // and there isnt a piece there, then we can perform the passant move
-  if (_board[to_x][to_y].type == PAWN &&
-      (dx == 1 && dy == 1) &&
-      !dest_piece_present)
-  {
-    _board[to_x + mod][to_y].Clear();
-    return MoveType::PERFORM_PASSANT;
+  const auto from = toSquare(m.from.x, m.from.y);
+  const auto to = toSquare(m.to.x, m.to.y);
+  const auto promotion = m.promotion == NONE ? QUEEN : m.promotion;
+
+  for (auto legal : genLegal(_side_to_move)) {
+    if (legal.from() == from && legal.to() == to &&
+        (!legal.isPromotion() || legal.promotion() == promotion))
+    {
+      return legal;
+    }
   }
+  return PackedMove {};
+}
 
-  if (is_castle) {
-    auto dx = to_x - from_x;
-    auto dy = to_y - from_y;
-    auto king_x = to_x;
-    auto king_y = to_y;
-
-    // if the difference in y is positive, its a king side castle
-    // move the rook to the correct position
-    if (dy > 0) {
-      do_move(Move { Point {king_x, king_y + 1} , Point {king_x, king_y - 1} });
-      return MoveType::K_SIDE_CASTLE;
-    } else {
-      // queen side castle
-      do_move(Move { Point {king_x, king_y - 2} , Point {king_x, king_y + 1} });
-      return MoveType::Q_SIDE_CASTLE;
-    } 
+/******************************************************************************
+ * PUBLIC
+ * Method: BoardManager::makeMove(PackedMove m)
+ *
+ * - plays the move and records what is needed to undo it
+ *****************************************************************************/
+void BoardManager::makeMove(PackedMove m)
+{
+  const auto from = m.from();
+  const auto to = m.to();
+  const auto moved = typeAt(from);
+
+  Undo u;
+  u.move = m;
+  u.captured = typeAt(to);
+  u.castling_rights = _castling_rights;
+  u.passant_target = _passant_target;
+  u.halfmove_clock = _halfmove_clock;
+  u.key = _key;
+
+  _key ^= passantKey();
+  do_move(m);
+  _undo_stack.push_back(u);
+
+  _key ^= Zobrist::keys.castling[u.castling_rights] ^
+          Zobrist::keys.castling[_castling_rights];
+
+  if (m.flag() == PackedMove::DOUBLE_PUSH) {
+    // the square the pawn skipped over
+    _passant_target = (from + to) / 2;
+  } else {
+    _passant_target = NO_SQUARE;
   }
 
-  // this will let use know that we can en_passant on the next move
-  if (_board[to_x][to_y].type == PAWN &&
-      (dx == 2))
-  {
-    return MoveType::ENABLE_PASSANT;
+  if (moved == PAWN || u.captured != NONE) {
+    _halfmove_clock = 0;
+  } else {
+    _halfmove_clock++;
+  }
+
+  // black is moving, increment the full move count
+  if (_side_to_move == BLACK) {
+    _move_count++;
   }
 
-  return MoveType::NORMAL;
+  _side_to_move = opposite(_side_to_move);
+  _half_move_count++;
+
+  _key ^= Zobrist::keys.side ^ passantKey();
 }
 
 /******************************************************************************
  * PUBLIC
- * Method: BoardManager::isCheckmate()
+ * Method: BoardManager::unmakeMove()
  *
+ * - takes back the last move made with makeMove
  *****************************************************************************/
-bool BoardManager::isCheckmate()
+void BoardManager::unmakeMove()
 {
-  const auto cur_player_color = _isWhiteTurn ? WHITE : BLACK;
-
-  // check if all the possible moves for the current player result in check
-  for (int i = 0; i < 8; i++) {
-    for (int j = 0; j < 8; j++) {
-      auto piece = _board[i][j];
-      if (piece && piece.Color() == cur_player_color) {
-        auto this_piece_possible = GPM_Piece(piece);
-        for (auto move : this_piece_possible) {
-          if (!resultsInCheck(move)) {
-            return false; 
-          }
-        }
-      }
+  assert(!_undo_stack.empty());
+  const auto u = _undo_stack.back();
+  _undo_stack.pop_back();
+
+  _side_to_move = opposite(_side_to_move);
+  _half_move_count--;
+  if (_side_to_move == BLACK) {
+    _move_count--;
+  }
+
+  const auto color = _side_to_move;
+  const auto from = u.move.from();
+  const auto to = u.move.to();
+  const auto placed = typeAt(to);
+
+  removePiece(to, color, placed);
+  putPiece(from, color, u.move.isPromotion() ? PAWN : placed);
+
+  if (u.captured != NONE) {
+    putPiece(to, opposite(color), u.captured);
+  }
+
+  switch (u.move.flag()) {
+    case PackedMove::EN_PASSANT:
+      putPiece(toSquare(from >> 3, to & 7), opposite(color), PAWN);
+      break;
+    case PackedMove::KING_CASTLE:
+      removePiece(to - 1, color, ROOK);
+      putPiece(to + 1, color, ROOK);
+      break;
+    case PackedMove::QUEEN_CASTLE:
+      removePiece(to + 1, color, ROOK);
+      putPiece(to - 2, color, ROOK);
+      break;
+    default:
+      break;
+  }
+
+  _castling_rights = u.castling_rights;
+  _passant_target = u.passant_target;
+  _halfmove_clock = u.halfmove_clock;
+  _key = u.key;
+}
+
+/******************************************************************************
+ * PUBLIC
+ * Method: BoardManager::makeNullMove()
+ *
+ * - the undo entry holds the null move, lastMove() says a pass was made
+ *****************************************************************************/
+void BoardManager::makeNullMove()
+{
+  Undo u;
+  u.move = PackedMove {};
+  u.captured = NONE;
+  u.castling_rights = _castling_rights;
+  u.passant_target = _passant_target;
+  u.halfmove_clock = _halfmove_clock;
+  u.key = _key;
+  _undo_stack.push_back(u);
+
+  _key ^= passantKey();
+  _passant_target = NO_SQUARE;
+  _halfmove_clock = 0;
+  _side_to_move = opposite(_side_to_move);
+  _key ^= Zobrist::keys.side;
+}
+
+/******************************************************************************
+ * PUBLIC
+ * Method: BoardManager::unmakeNullMove()
+ *
+ *****************************************************************************/
+void BoardManager::unmakeNullMove()
+{
+  assert(!_undo_stack.empty());
+  const auto u = _undo_stack.back();
+  _undo_stack.pop_back();
+
+  _side_to_move = opposite(_side_to_move);
+  _passant_target = u.passant_target;
+  _halfmove_clock = u.halfmove_clock;
+  _key = u.key;
+}
+
+/******************************************************************************
+ * PUBLIC
+ * Method: BoardManager::repetitions()
+ *
+ * - compares hashes of earlier positions with the same side to move,
+ *   nothing before the last capture or pawn move can repeat
+ *****************************************************************************/
+int BoardManager::repetitions() const
+{
+  int count = 0;
+  const int size = _undo_stack.size();
+  const int limit = std::min<int>(_halfmove_clock, size);
+
+  for (int i = 4; i <= limit; i += 2) {
+    if (_undo_stack[size - i].key == _key) {
+      count++;
     }
   }
+  return count;
+}
 
-  return true;
+/******************************************************************************
+ *
+ * Method: BoardManager::do_move(PackedMove)
+ * 
+ * - performs the move, the flag says whether anything besides the
+ *   moving piece and whatever is on its destination is involved
+ *****************************************************************************/
+void BoardManager::do_move(PackedMove m)
+{
+  // castling rights that survive a move touching each square,
+  // moving a king or rook, or capturing a rook, loses the right
+  static constexpr auto castle_mask = [] {
+    std::array<uint8_t, 64> mask {};
+    mask.fill(0xF);
+    mask[toSquare(7, 4)] = ~(WHITE_KING_SIDE | WHITE_QUEEN_SIDE) & 0xF;
+    mask[toSquare(7, 7)] = ~WHITE_KING_SIDE & 0xF;
+    mask[toSquare(7, 0)] = ~WHITE_QUEEN_SIDE & 0xF;
+    mask[toSquare(0, 4)] = ~(BLACK_KING_SIDE | BLACK_QUEEN_SIDE) & 0xF;
+    mask[toSquare(0, 7)] = ~BLACK_KING_SIDE & 0xF;
+    mask[toSquare(0, 0)] = ~BLACK_QUEEN_SIDE & 0xF;
+    return mask;
+  }();
+
+  const auto from = m.from();
+  const auto to = m.to();
+  const auto type = typeAt(from);
+  const auto color = colorAt(from);
+  const auto captured = typeAt(to);
+
+  if (captured != NONE) {
+    removePiece(to, colorAt(to), captured);
+  }
+
+  removePiece(from, color, type);
+
+  putPiece(to, color, m.isPromotion() ? m.promotion() : type);
+
+  _castling_rights &= castle_mask[from] & castle_mask[to];
+
+  switch (m.flag()) {
+    case PackedMove::EN_PASSANT:
+      // the pawn being taken is beside the one taking it
+      removePiece(toSquare(from >> 3, to & 7), opposite(color), PAWN);
+      break;
+    case PackedMove::KING_CASTLE:
+      removePiece(to + 1, color, ROOK);
+      putPiece(to - 1, color, ROOK);
+      break;
+    case PackedMove::QUEEN_CASTLE:
+      removePiece(to - 2, color, ROOK);
+      putPiece(to + 1, color, ROOK);
+      break;
+    default:
+      break;
+  }
+}
+
+/******************************************************************************
+ * PUBLIC
+ * Method: BoardManager::isCheckmate()
+ *
+ *****************************************************************************/
+bool BoardManager::isCheckmate()
+{
+  return isColorInCheck(_side_to_move) && genLegal(_side_to_move).empty();
 }
 
 /******************************************************************************
@@ -213,7 +363,7 @@ bool BoardManager::isCheckmate()
  *****************************************************************************/
 Piece BoardManager::pieceAt(int x, int y)
 {
-  return validPoint(x, y) ? _board[x][y] : Piece();
+  return validPoint(x, y) ? _board[toSquare(x, y)] : Piece();
 }
 
 /******************************************************************************
@@ -240,133 +390,115 @@ const std::string BoardManager::historyAt(int index)
  *****************************************************************************/
 const bool BoardManager::colorMatchesTurn(Color c)
 {
-  return (c == WHITE && _isWhiteTurn) ||
-         (c == BLACK && !_isWhiteTurn);
+  return c == _side_to_move;
 }
 
 /******************************************************************************
- * PUBLIC
- * Method: BoardManager::colorMatchesTurn(Color)
+ *
+ * Method: BoardManager::initBoard()
+ *
  *****************************************************************************/
-std::vector<Move> BoardManager::genPossibleOpposing(Color c)
+void BoardManager::initBoard()
 {
-  return GAPM_Opposing(c);
+  fen_to_state("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 0");
+
+  _history.clear();
+  _history.push_back(board_to_fen());
 }
 
 /******************************************************************************
  *
- * Method: BoardManager::resultsInCheck(Move m)
+ * Method: BoardManager::clearBoard()
  *
- * -- given a proposed move, see if that move results in check
- *    for the same color piece
  *****************************************************************************/
-bool BoardManager::resultsInCheck(Move m)
+void BoardManager::clearBoard()
 {
-  auto pieceColor = _board[m.from.x][m.from.y].Color();
-  std::vector<Move> possible;
-  auto dy_pos = abs(m.from.y - m.to.y);
-
-  // castling move, cant castle out of, through, or into check
-  if (_board[m.from.x][m.from.y].type == KING && dy_pos >= 2) {
-  
-    auto y_dir = m.to.y - m.from.y < 0 ? -1 : 1;
-    possible = GAPM_Opposing(pieceColor);
-
-    return (containsPoint(m.from.x, m.from.y, possible) ||
-            containsPoint(m.from.x, m.from.y + (1 * y_dir), possible) ||
-            containsPoint(m.from.x, m.from.y + (2 * y_dir), possible));
-  } else {
-     
-    auto prev_fen = board_to_fen();
-    auto prev_history = _history;
-    auto prev_board(_board);
-
-    do_move(m);
-
-    possible = GAPM_Opposing(pieceColor);
+  _pieces.fill(0);
+  _occupancy.fill(0);
+  _board.fill(Piece());
+  _side_to_move = WHITE;
+  _castling_rights = 0;
+  _passant_target = NO_SQUARE;
+  _move_count = 0;
+  _half_move_count = 0;
+  _halfmove_clock = 0;
+  _key = 0;
+  _psqt = {};
+  _phase = 0;
+  _undo_stack.clear();
+}
 
-    auto king = getKing(pieceColor);
+/******************************************************************************
+ *
+ * Method: BoardManager::putPiece(Square, Color, PieceType)
+ *
+ *****************************************************************************/
+void BoardManager::putPiece(Square s, Color c, PieceType t)
+{
+  _pieces[c * 6 + t - 1] |= squareBB(s);
+  _occupancy[c] |= squareBB(s);
+  _board[s] = Piece(t, c);
+  _key ^= Zobrist::keys.pieces[c * 6 + t - 1][s];
+  _psqt += Psqt::score(c, t, s);
+  _phase += Psqt::phaseWeight(t);
+}
 
-    auto res = containsPoint(king.x, king.y, possible);
+/******************************************************************************
+ *
+ * Method: BoardManager::removePiece(Square, Color, PieceType)
+ *
+ *****************************************************************************/
+void BoardManager::removePiece(Square s, Color c, PieceType t)
+{
+  _pieces[c * 6 + t - 1] &= ~squareBB(s);
+  _occupancy[c] &= ~squareBB(s);
+  _board[s].Clear();
+  _key ^= Zobrist::keys.pieces[c * 6 + t - 1][s];
+  _psqt -= Psqt::score(c, t, s);
+  _phase -= Psqt::phaseWeight(t);
+}
 
-    // undo the move
-    fen_to_state(prev_fen);
+/******************************************************************************
+ *
+ * Method: BoardManager::computeKey()
+ *
+ * - the zobrist hash of the position from scratch
+ *****************************************************************************/
+uint64_t BoardManager::computeKey() const
+{
+  uint64_t key = Zobrist::keys.castling[_castling_rights] ^ passantKey();
 
-    // this is neseccary because FEN doesnt contain
-    // info about pieces that have or havent moved,
-    // and nothing about history obviously
-    _board = prev_board;
-    _history = prev_history;
+  auto occ = occupied();
+  while (occ) {
+    const auto s = popLsb(occ);
+    key ^= Zobrist::keys.pieces[colorAt(s) * 6 + typeAt(s) - 1][s];
+  }
 
-    return res;
+  if (_side_to_move == BLACK) {
+    key ^= Zobrist::keys.side;
   }
+  return key;
 }
 
 /******************************************************************************
  *
- * Method: BoardManager::initBoard()
+ * Method: BoardManager::passantKey()
  *
+ * - the en passant part of the hash, only when the side to move has a
+ *   pawn that can take, otherwise the positions are the same
  *****************************************************************************/
-void BoardManager::initBoard()
+uint64_t BoardManager::passantKey() const
 {
-  for (int i = 0; i < 8; i++) {
-    for (int j = 0; j < 8; j++) {
-      if (i == 0) {
-        if (j == 0) {
-          _board[i][j] = Piece(i, j, PieceType::ROOK, Color::BLACK);
-        } else if (j == 1) {
-          _board[i][j] = Piece(i, j, PieceType::KNIGHT, Color::BLACK);
-        } else if (j == 2) {
-          _board[i][j] = Piece(i, j, PieceType::BISHOP, Color::BLACK);
-        } else if (j == 3) {
-          _board[i][j] = Piece(i, j, PieceType::QUEEN, Color::BLACK);
-        } else if (j == 4) {
-          _board[i][j] = Piece(i, j, PieceType::KING, Color::BLACK);
-        } else if (j == 5) {
-          _board[i][j] = Piece(i, j, PieceType::BISHOP, Color::BLACK);
-        } else if (j == 6) {
-          _board[i][j] = Piece(i, j, PieceType::KNIGHT, Color::BLACK);
-        } else if (j == 7) {
-          _board[i][j] = Piece(i, j, PieceType::ROOK, Color::BLACK);
-        }
-        
-      } else if (i == 1) {
-        _board[i][j] = Piece(i, j, PieceType::PAWN, Color::BLACK);
-      } else if (i == 6) {
-        _board[i][j] = Piece(i, j, PieceType::PAWN, Color::WHITE);
-      } else if (i == 7) {
-        if (j == 0) {
-          _board[i][j] = Piece(i, j, PieceType::ROOK, Color::WHITE);
-        } else if (j == 1) {
-          _board[i][j] = Piece(i, j, PieceType::KNIGHT, Color::WHITE);
-        } else if (j == 2) {
-          _board[i][j] = Piece(i, j, PieceType::BISHOP, Color::WHITE);
-        } else if (j == 3) {
-          _board[i][j] = Piece(i, j, PieceType::QUEEN, Color::WHITE);
-        } else if (j == 4) {
-          _board[i][j] = Piece(i, j, PieceType::KING, Color::WHITE);
-        } else if (j == 5) {
-          _board[i][j] = Piece(i, j, PieceType::BISHOP, Color::WHITE);
-        } else if (j == 6) {
-          _board[i][j] = Piece(i, j, PieceType::KNIGHT, Color::WHITE);
-        } else if (j == 7) {
-          _board[i][j] = Piece(i, j, PieceType::ROOK, Color::WHITE);
-        }
-      } else {
-        // no piece
-        _board[i][j] = Piece(i, j);
-      }
-    }
+  if (_passant_target == NO_SQUARE) {
+    return 0;
   }
 
-  _history.clear();
-  _isWhiteTurn = true;
-  _move_count = 0;
-  _half_move_count = 0;
-  _history.push_back(board_to_fen());
+  const auto takers = pawnAttacks(opposite(_side_to_move), _passant_target);
+  return takers & pieces(_side_to_move, PAWN)
+    ? Zobrist::keys.passant[_passant_target & 7]
+    : 0;
 }
 
-
 /******************************************************************************
  * Method: BoardManaher::board_to_fen(x, y, possible)
  * 
@@ -377,93 +509,65 @@ std::string BoardManager::board_to_fen()
 {
   std::string fen = "";
   int empty = 0;
-  int x = 0;
-  int y = 0;
 
-  while (x < 8) {
-    while (y < 8) {
-      if (_board[x][y]) {
-        fen += _board[x][y].typeToFEN();
-        y++;
-      } else {
-        while (y < 8 && !_board[x][y]) {
-          empty++;
-          y++;
-        }
-        if (empty > 0 && empty <= 8) {
-          fen += std::to_string(empty);
-          empty = 0;
-        }
+  for (int x = 0; x < 8; x++) {
+    for (int y = 0; y < 8; y++) {
+      const auto s = toSquare(x, y);
+      if (typeAt(s) == NONE) {
+        empty++;
+        continue;
       }
+
+      if (empty > 0) {
+        fen += std::to_string(empty);
+        empty = 0;
+      }
+      fen += _board[s].typeToFEN();
     }
 
-    y = 0;
-    empty = 0;
+    if (empty > 0) {
+      fen += std::to_string(empty);
+      empty = 0;
+    }
 
     if (x != 7) {
       fen += "/";
     }
-
-    x++;
   }
 
   // add turn
-  fen += _isWhiteTurn ? " w " : " b ";
+  fen += _side_to_move == WHITE ? " w " : " b ";
 
   // castling rights
-  auto white_king = getKing(Color::WHITE);
-  auto black_king = getKing(Color::BLACK);
-  
-  if (pieceAt(white_king.x, white_king.y).has_moved &&
-      pieceAt(black_king.x, black_king.y).has_moved) 
-  {
+  if (!_castling_rights) {
     fen += "-";
-  } 
-  else { 
-
-    if (pieceAt(0,7).type == ROOK &&
-        !pieceAt(0, 7).has_moved &&
-        !pieceAt(black_king.x, black_king.y).has_moved)
-    {
+  } else {
+    if (_castling_rights & WHITE_KING_SIDE) {
       fen += "K";
     }
-
-    if (pieceAt(0,0).type == ROOK &&
-        !pieceAt(0, 0).has_moved &&
-        !pieceAt(black_king.x, black_king.y).has_moved)
-    {
+    if (_castling_rights & WHITE_QUEEN_SIDE) {
       fen += "Q";
     }
-
-
-    if (pieceAt(7,7).type == ROOK &&
-        !pieceAt(7, 7).has_moved &&
-        !pieceAt(white_king.x, white_king.y).has_moved)
-    {
+    if (_castling_rights & BLACK_KING_SIDE) {
       fen += "k";
     }
-
-    if (pieceAt(7,0).type == ROOK &&
-        !pieceAt(7, 0).has_moved &&
-        !pieceAt(white_king.x, white_king.y).has_moved)
-    {
+    if (_castling_rights & BLACK_QUEEN_SIDE) {
       fen += "q";
     }
-
   }
 
   fen += " ";
 
   // en passant target square
-  if (_en_passant_enabled && validPoint(_passant_target.x, _passant_target.y))
+  if (_passant_target != NO_SQUARE)
   {
-    fen += point_to_fen(_passant_target) + " ";
+    fen += point_to_fen(toPoint(_passant_target)) + " ";
   } else {
     fen += "- ";
   }
 
   // halfmove clock
-  fen += std::to_string(_half_move_count) + " ";
+  fen += std::to_string(_halfmove_clock) + " ";
 
   // fullmove number
   fen += std::to_string(_move_count);
@@ -490,21 +594,52 @@ void BoardManager::fen_to_state(std::string fen)
    
   assert(tokens.size() == 6);
 
-  // assuming copillot is correct
-  _board = fen_to_board(tokens[0]);
-  _isWhiteTurn = tokens[1] == "w" ? true : false;
+  clearBoard();
+
+  int x = 0;
+  int y = 0;
+  for (auto c : tokens[0]) {
+    if (c == '/') {
+      x++;
+      y = 0;
+    } else if (c >= '1' && c <= '8') {
+      y += c - '0';
+    } else {
+      putPiece(toSquare(x, y), isupper(c) ? WHITE : BLACK, fen_to_type(c));
+      y++;
+    }
+  }
 
-  // i dont care about castling rights (yet)
-  // _casling_rights = tokens[2];
+  _side_to_move = tokens[1] == "w" ? WHITE : BLACK;
+
+  for (auto c : tokens[2]) {
+    switch (c) {
+      case 'K':
+        _castling_rights |= WHITE_KING_SIDE;
+        break;
+      case 'Q':
+        _castling_rights |= WHITE_QUEEN_SIDE;
+        break;
+      case 'k':
+        _castling_rights |= BLACK_KING_SIDE;
+        break;
+      case 'q':
+        _castling_rights |= BLACK_QUEEN_SIDE;
+        break;
+      default:
+        break;
+    }
+  }
   
-  _en_passant_enabled = tokens[3] == "-" ? false : true;
-  if (_en_passant_enabled) {
-    _passant_target = fen_to_point(tokens[3]);
+  if (tokens[3] != "-") {
+    auto p = fen_to_point(tokens[3]);
+    _passant_target = toSquare(p.x, p.y);
   } else {
-    _passant_target = Point{-1, -1};
+    _passant_target = NO_SQUARE;
   }
-  _half_move_count = std::stoi(tokens[4]);
+  _halfmove_clock = std::stoi(tokens[4]);
   _move_count = std::stoi(tokens[5]);
+  _key = computeKey();
 }
 
 /******************************************************************************
@@ -514,7 +649,7 @@ void BoardManager::fen_to_state(std::string fen)
  *****************************************************************************/
 BoardManager::Board BoardManager::fen_to_board(std::string fen) {
 
-  Board b = std::vector<std::vector<Piece>>(8, std::vector<Piece>(8));
+  Board b = {};
   int x = 0;
   int y = 0;
   for (auto c : fen) {
@@ -526,7 +661,7 @@ BoardManager::Board BoardManager::fen_to_board(std::string fen) {
     } else if (c >= '1' && c <= '8') {
       y += c - '0';
     } else {
-      b[x][y] = Piece(x, y, fen_to_type(c), isupper(c) ? WHITE : BLACK);
+      b[toSquare(x, y)] = Piece(fen_to_type(c), isupper(c) ? WHITE : BLACK);
       y++;
     }
   }
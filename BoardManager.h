@@ -1,8 +1,14 @@
 #pragma once
 
+#include <array>
+#include <string>
 #include <vector>
 #include "common_enums.h"
+#include "Bitboard.h"
+#include "MoveList.h"
 #include "Piece.h"
+#include "Psqt.h"
+#include "Zobrist.h"
 
 class BoardManager {
   public: 
@@ -10,17 +16,38 @@ class BoardManager {
 
     BoardManager(std::string fen);
 
-    using Board = std::vector<std::vector<Piece>>;
+    // the mailbox, indexed by Square
+    using Board = std::array<Piece, 64>;
 
     bool isCheckmate();
 
     void reset();
-    std::vector<Move> genPossible(Piece p);
+    MoveList genPossible(Point p);
 
-    bool resultsInCheck(Move m);
+    // every legal move for the color, pins and checks are resolved
+    // during generation so nothing needs to be filtered afterwards
+    MoveList genLegal(Color c);
+
+    // only the legal captures and promotions, for the quiescence search
+    MoveList genCaptures(Color c);
 
     // try and move if true, the move took place
     MoveResult move(Move m);
+    MoveResult move(PackedMove m);
+
+    // the legal move the UI means by a move between two grid points,
+    // the null move if there isnt one
+    PackedMove findMove(Move m);
+
+    // play a move without any legality checks and push what is needed to
+    // take it back onto the undo stack, unmakeMove pops the last one
+    void makeMove(PackedMove m);
+    void unmakeMove();
+
+    // pass the turn, for null move pruning. Nothing before the pass
+    // counts towards a repetition after it
+    void makeNullMove();
+    void unmakeNullMove();
 
     Piece pieceAt(int x, int y);
 
@@ -29,10 +56,10 @@ class BoardManager {
     const std::string historyAt(int index);
 
     const bool colorMatchesTurn(Color c);
-    std::vector<Move> genPossibleOpposing(Color c);
 
     const uint32_t MoveCount() const {return _move_count;};
     const uint32_t HalfMoveCount() const {return _half_move_count;};
+    uint32_t HalfMoveClock() const {return _halfmove_clock;};
 
     Board fen_to_board(std::string fen);
     std::string board_to_fen();
@@ -40,47 +67,126 @@ class BoardManager {
     PieceType fen_to_type(char c);
 
     const bool isColorInCheck(Color c);
-    bool containsPoint(int x, int y, std::vector<Move> possible);
 
-  private:
+    // every piece of color by that attacks the square
+    Bitboard attackersTo(Square s, Color by) const {
+      return attackersTo(s, by, occupied());
+    }
+    Bitboard attackersTo(Square s, Color by, Bitboard occupied) const;
+    bool isSquareAttacked(Square s, Color by) const {
+      return attackersTo(s, by) != 0;
+    }
+
+    // static exchange evaluation, the material the side making the move
+    // ends up with once both sides have recaptured on its destination for
+    // as long as it pays, found from attacker sets without making moves
+    int see(PackedMove m) const;
+
+    // bitboard accessors
+    Bitboard pieces(Color c, PieceType t) const {
+      return _pieces[c * 6 + t - 1];
+    }
+    Piece pieceOn(Square s) const { return _board[s]; }
+    Bitboard occupancy(Color c) const { return _occupancy[c]; }
+    Bitboard occupied() const { return _occupancy[WHITE] | _occupancy[BLACK]; }
+    Color sideToMove() const { return _side_to_move; }
+
+    // the move unmakeMove would take back, the null move if there isnt one
+    PackedMove lastMove() const {
+      return _undo_stack.empty() ? PackedMove {} : _undo_stack.back().move;
+    }
+
+    // zobrist hash of the position, kept up to date by make/unmake
+    uint64_t key() const { return _key; }
 
-    
-    // dont need this anymore, leaving for now
-    enum MoveType {
-      NORMAL = 0,
-      Q_SIDE_CASTLE = 1,
-      K_SIDE_CASTLE = 2,
+    // castling rights from the lowest bit, white king side, white queen
+    // side, black king side then black queen side
+    uint8_t castlingRights() const { return _castling_rights; }
+    // the square the last move's double push skipped over, NO_SQUARE if
+    // the last move wasnt one
+    Square passantTarget() const { return _passant_target; }
 
-      // next move can be en passant
-      ENABLE_PASSANT = 3,
+    // material and square table sums for both sides, white's minus
+    // black's, and the game phase, kept up to date the same way
+    Psqt::Score psqt() const { return _psqt; }
+    int phase() const { return _phase; }
 
-      // a passant move was just made
-      PERFORM_PASSANT = 4
+    // how many times the current position has been seen before, only
+    // looking back as far as the last capture or pawn move
+    int repetitions() const;
+
+  private:
+
+    // everything makeMove destroys that unmakeMove cant work out again,
+    // the move's flag says whether a rook or en passant pawn goes back
+    struct Undo {
+      PackedMove move;
+      PieceType captured;
+      uint8_t castling_rights;
+      Square passant_target;
+      uint32_t halfmove_clock;
+      uint64_t key;
     };
 
-    Board _board;
+    enum CastlingRights {
+      WHITE_KING_SIDE = 1,
+      WHITE_QUEEN_SIDE = 2,
+      BLACK_KING_SIDE = 4,
+      BLACK_QUEEN_SIDE = 8
+    };
+
+    // one bitboard per color and piece type, indexed by color * 6 + type - 1
+    std::array<Bitboard, 12> _pieces = {};
+    // the same position by square, for answering whats on a square
+    Board _board = {};
+    std::array<Bitboard, 2> _occupancy = {};
+    Color _side_to_move = WHITE;
+    uint8_t _castling_rights = 0;
+    Square _passant_target = NO_SQUARE;
+    uint64_t _key = 0;
+    Psqt::Score _psqt = {};
+    int _phase = 0;
+
     uint32_t _move_count = 0;
+    // plies played since the position was set up
     uint32_t _half_move_count = 0;
+    // plies since the last capture or pawn move, for the 50 move rule
+    uint32_t _halfmove_clock = 0;
 
+    std::vector<Undo> _undo_stack;
+
+    // FEN of every position in the game, only for the UI to step through
     std::vector<std::string> _history;
 
 
     void fen_to_state(std::string fen);
 
     void initBoard();
-    bool _en_passant_enabled = false;
-    Point _passant_target = {-1, -1};
-    bool _isWhiteTurn = true;
+    void clearBoard();
+
+    uint64_t computeKey() const;
+    uint64_t passantKey() const;
+
+    void putPiece(Square s, Color c, PieceType t);
+    void removePiece(Square s, Color c, PieceType t);
+    PieceType typeAt(Square s) const { return _board[s].type; }
+    Color colorAt(Square s) const { return _board[s].color; }
 
     // move generation and helpers
-    std::vector<Move> GPM_Piece(Piece p);
-    std::vector<Move> GAPM_Opposing(Color c);
-    std::vector<Move> rookPossible(Piece p);
-    std::vector<Move> bishopPossible(Piece p);
+    void addMoves(Square from, Bitboard targets, MoveList& possible);
+    template<Bitboard LastRank>
+    void addPawnMoves(int offset, Bitboard targets, uint8_t flag,
+                      MoveList& possible);
+    enum GenType {
+      ALL_MOVES,
+      CAPTURES
+    };
+
+    template<Color Us, GenType Type>
+    void genLegal(MoveList& legal);
 
-    MoveType do_move(Move m);
+    void do_move(PackedMove m);
 
-    Point getKing(Color c);
     Point fen_to_point(std::string fen);
     std::string point_to_fen(Point p);
 
@@ -1,467 +1,390 @@
 #include "BoardManager.h"
+#include <algorithm>
+#include <initializer_list>
 
 /******************************************************************************
  *
- * Method: BoarManager::GPM_Piece(Piece p, const _board&)
- * - generate the possible moves for a given piece and _board 
+ * Method: BoarManager::genLegal(Color)
+ *
  *****************************************************************************/
-std::vector<Move> BoardManager::GPM_Piece(Piece p)
+MoveList BoardManager::genLegal(Color c)
 {
-  Point start = {p.x, p.y};
-
-  std::vector<Move> possible;
-  auto mod = p.color == Color::WHITE ? 1 : -1;
-
-  // determine if move is possible for knight and king
-  auto knightKing = [&] (auto x, auto y) {
-    if (validPoint(x,y)) {
-      if (!_board[x][y] || (_board[x][y] && _board[x][y].Color() != p.Color())) {
-        possible.push_back(Move{start, Point{x, y}});
-      }
-    }
-  };
-
-  switch (p.type) {
-    case PAWN:
-    {
-      // if there isnt a piece in front of the pawn, its possible
-      if (validPoint(p.x -mod, p.y) && !_board[p.x - mod][p.y]) {
-        possible.push_back(Move{start, Point{p.x - mod, p.y}});
-      }
-
-      if (validPoint(p.x-mod, p.y-mod) &&
-          _board[p.x - mod][p.y - mod] && p.color != _board[p.x-mod][p.y-mod].color) {
-        possible.push_back(Move {start, Point{p.x - mod, p.y - mod} });
-      }
-
-      if (validPoint(p.x-mod, p.y + mod) && 
-          _board[p.x - mod][p.y + mod] && p.Color() != _board[p.x-mod][p.y+mod].Color()) {
-        possible.push_back(Move {start,Point{p.x - mod, p.y + mod}});
-      }
-
-
-     if (!p.has_moved &&
-       validPoint(p.x - mod, p.y) &&
-       !_board[p.x - mod][p.y] &&
-       validPoint(p.x - mod*2, p.y) &&
-       !_board[p.x - mod*2][p.y])
-     {
-       possible.push_back(Move {start,Point{p.x - mod*2, p.y} });
-     }
-
-     // en passant
-     if (_en_passant_enabled) {
-      auto m = p.color == Color::WHITE ? 1 : -1;
-      if (validPoint(p.x, p.y -1) &&
-          _board[p.x][p.y - 1].type == PAWN &&
-          _board[p.x][p.y - 1].color != p.color) 
-      {
-        possible.push_back(Move {start, Point {p.x - m, p.y - 1} });
-
-      } else if (validPoint(p.x, p.y + 1) &&
-                 _board[p.x][p.y + 1].type == PAWN &&
-                 _board[p.x][p.y + 1].color != p.color) 
-      {
-        possible.push_back(Move {start, Point {p.x - m, p.y + 1} });
-      }
-     }
-
-     break;
-   }
-
-   case ROOK:
-   { 
-      auto rook = rookPossible(p);
-      possible.insert(std::end(possible), std::begin(rook), std::end(rook));
-      break;
-   }
-
-   case KING:
-   {
-     {
-       auto x = p.x - 1;
-       auto y = p.y - 1;
-       knightKing(x,y);
-     }
-
-     {
-       auto x = p.x;
-       auto y = p.y - 1;
-       knightKing(x,y);
-     }
-
-     {
-       auto x = p.x + 1;
-       auto y = p.y - 1;
-       knightKing(x,y);
-     }
-
-     {
-       auto x = p.x + 1;
-       auto y = p.y;
-       knightKing(x,y);
-     }
-
-     {
-       auto x = p.x - 1;
-       auto y = p.y;
-       knightKing(x,y);
-     }
-
-     {
-       auto x = p.x - 1;
-       auto y = p.y + 1;
-       knightKing(x,y);
-     }
-
-     {
-       auto x = p.x;
-       auto y = p.y + 1;
-       knightKing(x,y);
-     }
-
-     {
-       auto x = p.x + 1;
-       auto y = p.y + 1;
-       knightKing(x,y);
-     }
-
-     {
-       // castling
-       // if the king hasnt moved
-       if (!p.has_moved) {
-         // if im not already in check
-         if (validPoint(p.x, p.y + 3) &&
-             _board[p.x][p.y + 3] &&
-             _board[p.x][p.y + 3].type == ROOK &&
-             !_board[p.x][p.y + 3].has_moved)
-         {
-           // if traveling to either of the next to squares dont result in check
-           if (!_board[p.x][p.y + 1]) {
-             if (!_board[p.x][p.y + 2]) {
-               possible.push_back(Move{start, Point {p.x, p.y + 2} });
-             }
-           }
-         }
-
-         // queen side castle
-         // if im not already in check
-         if (validPoint(p.x, p.y - 4) &&
-             _board[p.x][p.y - 4] &&
-             _board[p.x][p.y - 4].type == ROOK &&
-             !_board[p.x][p.y - 4].has_moved)
-         {
-           // if traveling to either of the next to squares dont result in check
-           if (!_board[p.x][p.y - 1]) {
-             if (!_board[p.x][p.y - 2]) {
-               if (!_board[p.x][p.y - 3]) {
-                 possible.push_back(Move{start, Point {p.x, p.y - 2}});
-               }
-             }
-           }
-         }
-       }
-     }
-     break;
-   }   
-   case KNIGHT:
-   {
-     {
-       auto x = p.x - 2;
-       auto y = p.y + 1;
-       knightKing(x,y);
-     }
- 
-     {
-       auto x = p.x - 2;
-       auto y = p.y - 1;
-       knightKing(x,y);
-     }
-
-     {
-       auto x = p.x - 1;
-       auto y = p.y - 2;
-       knightKing(x,y);
-     }
-
-     {
-       auto x = p.x + 1;
-       auto y = p.y - 2;
-       knightKing(x,y);
-     }
-
-     {
-       auto x = p.x + 2;
-       auto y = p.y - 1;
-       knightKing(x,y);
-     }
-
-     {
-       auto x = p.x + 2;
-       auto y = p.y + 1;
-       knightKing(x,y);
-     }
-
-     {
-       auto x = p.x + 1;
-       auto y = p.y + 2;
-       knightKing(x,y);
-     }
-
-     {
-       auto x = p.x - 1;
-       auto y = p.y + 2;
-       knightKing(x,y);
-     }
-     break;
-   }
-
-   case BISHOP:
-   {
-     auto b = bishopPossible(p);
-     possible.insert(std::end(possible), std::begin(b), std::end(b)); 
-     break;
-   }
-
-   case QUEEN:
-   {
-     auto b = bishopPossible(p);
-     possible.insert(std::end(possible), std::begin(b), std::end(b)); 
-     auto c = rookPossible(p);
-     possible.insert(std::end(possible), std::begin(c), std::end(c)); 
-     break;
-   }
-
-   default:
-     break;
+  MoveList legal;
+  if (c == WHITE) {
+    genLegal<WHITE, ALL_MOVES>(legal);
+  } else if (c == BLACK) {
+    genLegal<BLACK, ALL_MOVES>(legal);
   }
-  return possible;
+  return legal;
 }
 
 /******************************************************************************
  *
- * Method: BoarManager::GAPM_Opposing(Color, const _board&)
- * 
- * - generate all possible moves for the opposing color
+ * Method: BoarManager::genCaptures(Color)
+ *
  *****************************************************************************/
-std::vector<Move> BoardManager::GAPM_Opposing(Color c)
+MoveList BoardManager::genCaptures(Color c)
 {
-  std::vector<Move> possible;
-  for (int i = 0; i < 8; i++) {
-    for (int j = 0; j < 8; j ++) {
-      if (_board[i][j] && _board[i][j].Color() != c) {
-        auto piecePossible = GPM_Piece(_board[i][j]);
-        possible.insert(std::end(possible),
-                        std::begin(piecePossible),
-                        std::end(piecePossible));
-      }
-    }
+  MoveList legal;
+  if (c == WHITE) {
+    genLegal<WHITE, CAPTURES>(legal);
+  } else if (c == BLACK) {
+    genLegal<BLACK, CAPTURES>(legal);
   }
-  return possible; 
+  return legal;
 }
 
 /******************************************************************************
  *
- * Method: BoarManager::rookPossible(Piece, const _board&)
- *
+ * Method: BoarManager::genLegal<Color, GenType>(MoveList&)
+ * - generate the legal moves for the color, with CAPTURES only the
+ *   captures and promotions
  *****************************************************************************/
-std::vector<Move> BoardManager::rookPossible(Piece p)
+template<Color Us, BoardManager::GenType Type>
+void BoardManager::genLegal(MoveList& legal)
 {
-  std::vector<Move> possible;
-  Point start = {p.x, p.y};
-  {
-    auto x = p.x + 1;
-    auto y = p.y;
-    while (validPoint(x, y)) {
-      if (!_board[x][y]) {
-        possible.push_back(Move {start,Point{x, y}});
-        x++;
-      } else if (_board[x][y].Color() != p.Color()) {
-        possible.push_back(Move {start,Point{x, y}});
-        break;
-      } else {
-        break;
-      }
+  constexpr Color Them = Us == WHITE ? BLACK : WHITE;
+  constexpr int Up = Us == WHITE ? -8 : 8;
+  constexpr Bitboard Rank3 = Us == WHITE ? RANK_3 : RANK_6;
+  constexpr Bitboard LastRank = Us == WHITE ? RANK_8 : RANK_1;
+  constexpr Square Home = Us == WHITE ? 60 : 4;
+  constexpr uint8_t KingSide = Us == WHITE ? WHITE_KING_SIDE : BLACK_KING_SIDE;
+  constexpr uint8_t QueenSide = Us == WHITE ? WHITE_QUEEN_SIDE : BLACK_QUEEN_SIDE;
+
+  const auto king_bb = pieces(Us, KING);
+  if (!king_bb) {
+    return;
+  }
+
+  const auto king = lsb(king_bb);
+  const auto own = _occupancy[Us];
+  const auto enemy = _occupancy[Them];
+  const auto occ = own | enemy;
+  const auto empty = ~occ;
+  const auto checkers = attackersTo(king, Them);
+  const auto wanted = Type == CAPTURES ? enemy : ~own;
+
+  // king moves, checked with the king off the board so it cant step
+  // back along a checking ray
+  auto king_targets = kingAttacks(king) & wanted;
+  while (king_targets) {
+    auto to = popLsb(king_targets);
+    if (!attackersTo(to, Them, occ ^ king_bb)) {
+      legal.push_back(PackedMove(king, to,
+        squareBB(to) & enemy ? PackedMove::CAPTURE : PackedMove::QUIET));
     }
   }
 
-  {
-    auto x = p.x - 1;
-    auto y = p.y;
-    while (validPoint(x, y)) {
-      if (!_board[x][y]) {
-        possible.push_back(Move {start,Point{x, y}});
-        x--;
-      } else if (_board[x][y].Color() != p.Color()) {
-        possible.push_back(Move {start,Point{x, y}});
-        break;
-      } else {
-        break;
-      }
+  // in double check only the king can move
+  if (popCount(checkers) > 1) {
+    return;
+  }
+
+  // squares that resolve a single check, everything but our own otherwise
+  const auto resolving =
+    checkers ? between(king, lsb(checkers)) | checkers : ~own;
+  const auto evasions = resolving & wanted;
+  // pushes go to empty squares, so CAPTURES only wants the promotions
+  const auto pushes = Type == CAPTURES ? resolving & LastRank : resolving;
+
+  // a piece is pinned when it is the only piece between the king
+  // and an enemy slider that lines up with it
+  const auto their_queens = pieces(Them, QUEEN);
+  auto snipers =
+    (rookAttacks(king, 0) & (pieces(Them, ROOK) | their_queens)) |
+    (bishopAttacks(king, 0) & (pieces(Them, BISHOP) | their_queens));
+
+  Bitboard pinned = 0;
+  while (snipers) {
+    auto blockers = between(king, popLsb(snipers)) & occ;
+    if (popCount(blockers) == 1) {
+      pinned |= blockers & own;
     }
   }
 
+  // pawns that are not pinned move all at once, the origin of each
+  // target is a fixed offset away
+  const auto pawns = pieces(Us, PAWN);
+  const auto free_pawns = pawns & ~pinned;
   {
-    auto x = p.x;
-    auto y = p.y + 1;
-    while (validPoint(x, y)) {
-      if (!_board[x][y]) {
-        possible.push_back(Move {start,Point{x, y}});
-        y++;
-      } else if (_board[x][y].Color() != p.Color()) {
-        possible.push_back(Move {start,Point{x, y}});
-        break;
-      } else {
-        break;
-      }
+    auto single = forward<Us>(free_pawns) & empty;
+    auto doubles = forward<Us>(single & Rank3) & empty & pushes;
+    single &= pushes;
+    auto east_captures = forward<Us>(east(free_pawns)) & enemy & evasions;
+    auto west_captures = forward<Us>(west(free_pawns)) & enemy & evasions;
+
+    addPawnMoves<LastRank>(-Up, single, PackedMove::QUIET, legal);
+    addPawnMoves<LastRank>(-Up - 1, east_captures, PackedMove::CAPTURE, legal);
+    addPawnMoves<LastRank>(-Up + 1, west_captures, PackedMove::CAPTURE, legal);
+
+    while (doubles) {
+      auto to = popLsb(doubles);
+      legal.push_back(PackedMove(to - 2 * Up, to, PackedMove::DOUBLE_PUSH));
     }
   }
 
-  {
-    auto x = p.x;
-    auto y = p.y - 1;
-    while (validPoint(x, y)) {
-      if (!_board[x][y]) {
-        possible.push_back(Move {start,Point{x, y}});
-        y--;
-      } else if (_board[x][y].Color() != p.Color()) {
-        possible.push_back(Move {start,Point{x, y}});
-        break; 
-      } else {
-        break; 
-      }
+  // a pinned pawn can only move along the pin
+  auto pinned_pawns = pawns & pinned;
+  while (pinned_pawns) {
+    const auto from = popLsb(pinned_pawns);
+    const auto pin = line(king, from);
+    const auto single = forward<Us>(squareBB(from)) & empty;
+    const auto doubles = forward<Us>(single & Rank3) & empty;
+    addPawnMoves<LastRank>(-Up, single & pushes & pin,
+                           PackedMove::QUIET, legal);
+    if (doubles & pushes & pin) {
+      legal.push_back(
+        PackedMove(from, from + 2 * Up, PackedMove::DOUBLE_PUSH));
+    }
+
+    auto taking = pawnAttacks(Us, from) & enemy & evasions & pin;
+    while (taking) {
+      const auto to = popLsb(taking);
+      addPawnMoves<LastRank>(from - to, squareBB(to),
+                             PackedMove::CAPTURE, legal);
     }
   }
-  return possible;
-}
 
-/******************************************************************************
- *
- * Method: BoarManager::bishopPossible(Piece, const _board&)
- *
- *****************************************************************************/
-std::vector<Move> BoardManager::bishopPossible(Piece p)
-{
-  std::vector<Move> possible;
-  Point start = {p.x, p.y};
-  {
-    auto x = p.x + 1;
-    auto y = p.y + 1;
-    while (validPoint(x, y)) {
-      if (!_board[x][y]) {
-        possible.push_back(Move {start,Point{x, y}});
-        x++;
-        y++;
-      } else if (_board[x][y].Color() != p.Color()) {
-        possible.push_back(Move {start,Point{x, y}});
-        break;
-      } else {
-        break;
+  // en passant removes two pieces from the same rank, so check the
+  // king against the board as it will look after the capture
+  if (_passant_target != NO_SQUARE && Us == _side_to_move) {
+    auto takers = pawnAttacks(Them, _passant_target) & pawns;
+    const auto taken = _passant_target - Up;
+    while (takers) {
+      const auto from = popLsb(takers);
+      const auto after =
+        (occ ^ squareBB(from) ^ squareBB(taken)) | squareBB(_passant_target);
+      if (!(attackersTo(king, Them, after) & ~squareBB(taken))) {
+        legal.push_back(
+          PackedMove(from, _passant_target, PackedMove::EN_PASSANT));
       }
     }
   }
 
-  {
-    auto x = p.x - 1;
-    auto y = p.y - 1;
-    while (validPoint(x, y)) {
-      if (!_board[x][y]) {
-        possible.push_back(Move {start,Point{x, y}});
-        x--;
-        y--;
-      } else if (_board[x][y].Color() != p.Color()) {
-        possible.push_back(Move {start,Point{x, y}});
-        break;
-      } else {
-        break;
-      }
+  // pinned knights can never move
+  auto knights = pieces(Us, KNIGHT) & ~pinned;
+  while (knights) {
+    const auto from = popLsb(knights);
+    addMoves(from, knightAttacks(from) & evasions, legal);
+  }
+
+  auto diagonal = pieces(Us, BISHOP) | pieces(Us, QUEEN);
+  while (diagonal) {
+    const auto from = popLsb(diagonal);
+    auto targets = bishopAttacks(from, occ) & evasions;
+    if (pinned & squareBB(from)) {
+      targets &= line(king, from);
     }
+    addMoves(from, targets, legal);
   }
 
-  {
-    auto x = p.x - 1;
-    auto y = p.y + 1;
-    while (validPoint(x, y)) {
-      if (!_board[x][y]) {
-        possible.push_back(Move {start,Point{x, y}});
-        y++;
-        x--;
-      } else if (_board[x][y].Color() != p.Color()) {
-        possible.push_back(Move {start,Point{x, y}});
-        break;
-      } else {
-        break; 
-      }
+  auto straight = pieces(Us, ROOK) | pieces(Us, QUEEN);
+  while (straight) {
+    const auto from = popLsb(straight);
+    auto targets = rookAttacks(from, occ) & evasions;
+    if (pinned & squareBB(from)) {
+      targets &= line(king, from);
     }
+    addMoves(from, targets, legal);
   }
 
-  {
-    auto x = p.x + 1;
-    auto y = p.y - 1;
-    while (validPoint(x, y)) {
-      if (!_board[x][y]) {
-        possible.push_back(Move {start,Point{x, y}});
-        y--;
-        x++;
-      } else if (_board[x][y].Color() != p.Color()) {
-        possible.push_back(Move {start,Point{x, y}});
-        break;
-      } else {
-        break;
-      }
+  // castling, never out of, through or into check
+  if (Type == ALL_MOVES && king == Home && !checkers) {
+    const auto rooks = pieces(Us, ROOK);
+
+    if ((_castling_rights & KingSide) &&
+        (rooks & squareBB(Home + 3)) &&
+        !(occ & between(Home, Home + 3)) &&
+        !attackersTo(Home + 1, Them) &&
+        !attackersTo(Home + 2, Them))
+    {
+      legal.push_back(PackedMove(Home, Home + 2, PackedMove::KING_CASTLE));
+    }
+
+    if ((_castling_rights & QueenSide) &&
+        (rooks & squareBB(Home - 4)) &&
+        !(occ & between(Home, Home - 4)) &&
+        !attackersTo(Home - 1, Them) &&
+        !attackersTo(Home - 2, Them))
+    {
+      legal.push_back(PackedMove(Home, Home - 2, PackedMove::QUEEN_CASTLE));
     }
   }
-  return possible;
 }
 
 /******************************************************************************
  *
- * Method: BoarManager::getKing(Color, const _board&)
+ * Method: BoarManager::addMoves(Square, Bitboard, MoveList&)
+ * - append a move from the square to every square in targets, anything
+ *   standing on a target is the other color's so it is a capture
+ *****************************************************************************/
+void BoardManager::addMoves(Square from, Bitboard targets,
+                            MoveList& possible)
+{
+  auto captures = targets & occupied();
+  auto quiets = targets & ~captures;
+  while (captures) {
+    possible.push_back(PackedMove(from, popLsb(captures), PackedMove::CAPTURE));
+  }
+  while (quiets) {
+    possible.push_back(PackedMove(from, popLsb(quiets)));
+  }
+}
+
+/******************************************************************************
  *
+ * Method: BoarManager::addPawnMoves<LastRank>(int, Bitboard, uint8_t,
+ *                                            MoveList&)
+ * - pawn moves to every target, each from the square offset away, all
+ *   quiet or all captures. A move to the last rank is added once for
+ *   every promotion piece
  *****************************************************************************/
-Point BoardManager::getKing(Color c)
+template<Bitboard LastRank>
+void BoardManager::addPawnMoves(int offset, Bitboard targets, uint8_t flag,
+                                MoveList& possible)
 {
-    for (int i = 0; i < 8; i ++) {
-      for (int j = 0; j < 8; j++) {
-        if (_board[i][j].type == KING && _board[i][j].Color() == c) {
-          return Point { _board[i][j].x, _board[i][j].y };
-        }
-      }
-    }
+  auto promotions = targets & LastRank;
+  targets &= ~LastRank;
+
+  while (targets) {
+    const auto to = popLsb(targets);
+    possible.push_back(PackedMove(to + offset, to, flag));
+  }
 
-    return Point {-1, -1};
+  const bool capture = flag == PackedMove::CAPTURE;
+  while (promotions) {
+    const auto to = popLsb(promotions);
+    for (auto promotion : { QUEEN, ROOK, BISHOP, KNIGHT }) {
+      possible.push_back(PackedMove(to + offset, to,
+        PackedMove::promotionFlag(promotion, capture)));
+    }
+  }
 }
 
 /******************************************************************************
  *
- * Method: BoarManager::isColorInCheck(Color, const _board&)
+ * Method: BoarManager::isColorInCheck(Color)
  * 
  *****************************************************************************/
 const bool BoardManager::isColorInCheck(Color c)
 {
-  auto otherColor = c == WHITE ? BLACK : WHITE;
-  auto possible = GAPM_Opposing(c);
+  const auto king = pieces(c, KING);
+  return king && isSquareAttacked(lsb(king), opposite(c));
+}
 
-  auto king = getKing(c);
+/******************************************************************************
+ *
+ * Method: BoarManager::attackersTo(Square, Color, Bitboard)
+ *
+ * - works backwards from the square, a piece of type T attacks the square
+ *   if a T standing on the square would attack it
+ *****************************************************************************/
+Bitboard BoardManager::attackersTo(Square s, Color by, Bitboard occupied) const
+{
+  const auto queens = pieces(by, QUEEN);
 
-  return containsPoint(king.x, king.y, possible);
+  return (pawnAttacks(opposite(by), s) & pieces(by, PAWN)) |
+         (knightAttacks(s) & pieces(by, KNIGHT)) |
+         (kingAttacks(s) & pieces(by, KING)) |
+         (bishopAttacks(s, occupied) & (pieces(by, BISHOP) | queens)) |
+         (rookAttacks(s, occupied) & (pieces(by, ROOK) | queens));
 }
 
 /******************************************************************************
  *
- * Method: BoarManager::containsPoint(x, y, possible)
- *
+ * Method: BoarManager::see(PackedMove)
+ * - plays out the captures on the destination square, each side taking
+ *   with its least valuable attacker
  *****************************************************************************/
-bool BoardManager::containsPoint(int x, int y, std::vector<Move> possible)
+int BoardManager::see(PackedMove m) const
 {
-  if (!validPoint(x,y)) {
-    return false;
+  if (m.isCastle()) {
+    return 0;
   }
 
-  for (auto move : possible) {
-    if (move.to.x == x && move.to.y == y) {
-      return true;
+  const auto from = m.from();
+  const auto to = m.to();
+
+  int gain[32];
+  int d = 0;
+
+  auto occ = occupied() ^ squareBB(from);
+  auto captured = typeAt(from);
+
+  if (m.flag() == PackedMove::EN_PASSANT) {
+    occ ^= squareBB(toSquare(from >> 3, to & 7));
+    gain[0] = pieceValue(PAWN);
+  } else {
+    gain[0] = pieceValue(typeAt(to));
+  }
+
+  if (m.isPromotion()) {
+    gain[0] += pieceValue(m.promotion()) - pieceValue(PAWN);
+    captured = m.promotion();
+  }
+
+  const auto diagonal = pieces(WHITE, BISHOP) | pieces(BLACK, BISHOP) |
+                        pieces(WHITE, QUEEN) | pieces(BLACK, QUEEN);
+  const auto straight = pieces(WHITE, ROOK) | pieces(BLACK, ROOK) |
+                        pieces(WHITE, QUEEN) | pieces(BLACK, QUEEN);
+
+  auto attackers =
+    (attackersTo(to, WHITE, occ) | attackersTo(to, BLACK, occ)) & occ;
+  auto side = opposite(colorAt(from));
+
+  while (true) {
+    const auto ours = attackers & _occupancy[side];
+    if (!ours) {
+      break;
     }
+
+    PieceType next = PAWN;
+    Bitboard taker = 0;
+    for (auto t : { PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING }) {
+      taker = ours & pieces(side, t);
+      if (taker) {
+        next = t;
+        break;
+      }
+    }
+
+    // a king only recaptures when nothing defends the square
+    if (next == KING && (attackers & _occupancy[opposite(side)])) {
+      break;
+    }
+
+    d++;
+    gain[d] = pieceValue(captured) - gain[d - 1];
+
+    // taking would leave this side worse off whatever follows, so it
+    // stops here and the capture doesnt count
+    if (std::max(-gain[d - 1], gain[d]) < 0) {
+      d--;
+      break;
+    }
+    if (d == 31) {
+      break;
+    }
+
+    // taking the attacker off uncovers any slider behind it
+    occ ^= taker & -taker;
+    captured = next;
+
+    if (next == PAWN || next == BISHOP || next == QUEEN) {
+      attackers |= bishopAttacks(to, occ) & diagonal;
+    }
+    if (next == ROOK || next == QUEEN) {
+      attackers |= rookAttacks(to, occ) & straight;
+    }
+    attackers &= occ;
+    side = opposite(side);
   }
-  return false;
+
+  // either side may stop, fold back taking the better of stopping or not
+  while (d > 0) {
+    gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+    d--;
+  }
+  return gain[0];
 }
+
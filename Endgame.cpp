@@ -0,0 +1,372 @@
+#include "Endgame.h"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+  /****************************************************************************
+   *
+   * KPK bitbase
+   *
+   * Every position is looked at with the pawn white, on files a to d, so the
+   * table only needs 24 pawn squares. Index bits are the white king, the
+   * black king, the side to move and the pawn, one bit per position says
+   * whether white wins. 196608 positions, 24KB
+   ***************************************************************************/
+  constexpr int KPK_SIZE = 2 * 24 * 64 * 64;
+
+  std::array<uint64_t, KPK_SIZE / 64> kpk_bits;
+
+  enum KPKResult : uint8_t {
+    INVALID = 0,
+    UNKNOWN = 1,
+    DRAW = 2,
+    WIN = 4
+  };
+
+  // pawns sit on rows 1 to 6, row 1 being the seventh rank
+  int kpkIndex(Color us, Square white_king, Square black_king, Square pawn)
+  {
+    const int pawn_index = ((pawn >> 3) - 1) * 4 + (pawn & 7);
+    return white_king | black_king << 6 | us << 12 | pawn_index << 13;
+  }
+
+  /****************************************************************************
+   *
+   * Function: kpkInitial(idx)
+   * - everything decided without looking at a move: illegal positions,
+   *   a pawn that queens safely and a king that takes the pawn or is
+   *   stalemated
+   ***************************************************************************/
+  KPKResult kpkInitial(int idx)
+  {
+    const Square wk = idx & 63;
+    const Square bk = (idx >> 6) & 63;
+    const Color us = Color((idx >> 12) & 1);
+    const int pawn_index = idx >> 13;
+    const Square pawn = toSquare(pawn_index / 4 + 1, pawn_index % 4);
+    const Square push = pawn - 8;
+
+    if (wk == bk || wk == pawn || bk == pawn ||
+        (kingAttacks(wk) & squareBB(bk)) ||
+        (us == WHITE && (pawnAttacks(WHITE, pawn) & squareBB(bk))))
+    {
+      return INVALID;
+    }
+
+    // queens on the next move and the new queen cannot be taken
+    if (us == WHITE && (pawn >> 3) == 1 && wk != push && bk != push &&
+        (!(kingAttacks(bk) & squareBB(push)) ||
+         (kingAttacks(wk) & squareBB(push))))
+    {
+      return WIN;
+    }
+
+    if (us == BLACK) {
+      const Bitboard covered = kingAttacks(wk) | pawnAttacks(WHITE, pawn);
+      if (!(kingAttacks(bk) & ~covered) ||
+          (kingAttacks(bk) & ~kingAttacks(wk) & squareBB(pawn)))
+      {
+        return DRAW;
+      }
+    }
+
+    return UNKNOWN;
+  }
+
+  /****************************************************************************
+   *
+   * Function: kpkClassify(db, idx)
+   * - white wins if one move wins, black draws if one move draws. Moves to
+   *   illegal positions come back INVALID and add nothing
+   ***************************************************************************/
+  KPKResult kpkClassify(const std::vector<KPKResult>& db, int idx)
+  {
+    const Square wk = idx & 63;
+    const Square bk = (idx >> 6) & 63;
+    const Color us = Color((idx >> 12) & 1);
+    const int pawn_index = idx >> 13;
+    const Square pawn = toSquare(pawn_index / 4 + 1, pawn_index % 4);
+
+    const KPKResult good = us == WHITE ? WIN : DRAW;
+    const KPKResult bad = us == WHITE ? DRAW : WIN;
+
+    int r = INVALID;
+    Bitboard moves = kingAttacks(us == WHITE ? wk : bk);
+    while (moves) {
+      const Square to = popLsb(moves);
+      r |= us == WHITE ? db[kpkIndex(BLACK, to, bk, pawn)]
+                       : db[kpkIndex(WHITE, wk, to, pawn)];
+    }
+
+    if (us == WHITE) {
+      // a blocked push lands a king on the pawn, which is INVALID
+      if ((pawn >> 3) > 1) {
+        r |= db[kpkIndex(BLACK, wk, bk, pawn - 8)];
+      }
+      if ((pawn >> 3) == 6 && pawn - 8 != wk && pawn - 8 != bk) {
+        r |= db[kpkIndex(BLACK, wk, bk, pawn - 16)];
+      }
+    }
+
+    return r & good ? good : r & UNKNOWN ? UNKNOWN : bad;
+  }
+
+  /****************************************************************************
+   *
+   * Function: buildKPK()
+   * - retrograde: start from what is known outright and go over the
+   *   unknown positions until a pass changes nothing, whatever is left
+   *   unknown then is a draw
+   ***************************************************************************/
+  void buildKPK()
+  {
+    std::vector<KPKResult> db(KPK_SIZE);
+    for (int idx = 0; idx < KPK_SIZE; idx++) {
+      db[idx] = kpkInitial(idx);
+    }
+
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      for (int idx = 0; idx < KPK_SIZE; idx++) {
+        if (db[idx] == UNKNOWN) {
+          db[idx] = kpkClassify(db, idx);
+          changed |= db[idx] != UNKNOWN;
+        }
+      }
+    }
+
+    kpk_bits.fill(0);
+    for (int idx = 0; idx < KPK_SIZE; idx++) {
+      if (db[idx] == WIN) {
+        kpk_bits[idx / 64] |= 1ULL << (idx % 64);
+      }
+    }
+  }
+
+  /****************************************************************************
+   *
+   * Recognizers
+   *
+   ***************************************************************************/
+  using Verdict = Endgame::Verdict;
+  using Recognizer = Verdict (*)(const BoardManager& board, Color strong);
+
+  struct Entry {
+    Recognizer recognize;
+    Color strong;
+  };
+
+  std::unordered_map<uint64_t, Entry> registry;
+  // more pieces than any registered signature and probe stops at a count
+  int max_pieces = 0;
+
+  int distance(Square a, Square b)
+  {
+    return std::max(std::abs((a >> 3) - (b >> 3)),
+                    std::abs((a & 7) - (b & 7)));
+  }
+
+  // how far from the middle of the board, 0 to 6
+  int edgeDistance(Square s)
+  {
+    const int x = s >> 3;
+    const int y = s & 7;
+    return std::max(3 - x, x - 4) + std::max(3 - y, y - 4);
+  }
+
+  Verdict forSideToMove(const BoardManager& board, Color strong,
+                        Verdict::Kind kind, int score)
+  {
+    return { kind, board.sideToMove() == strong ? score : -score };
+  }
+
+  /****************************************************************************
+   *
+   * Function: recognizeDraw(board, strong)
+   * - neither side has enough to mate with
+   ***************************************************************************/
+  Verdict recognizeDraw(const BoardManager&, Color)
+  {
+    return { Verdict::EXACT, 0 };
+  }
+
+  /****************************************************************************
+   *
+   * Function: recognizeKPK(board, strong)
+   * - a win is scored by how far the pawn has got and how close its king
+   *   is to the square in front, so the search still has a way forward
+   *   when it stops at every KPK position below the root
+   ***************************************************************************/
+  Verdict recognizeKPK(const BoardManager& board, Color strong)
+  {
+    const Color weak = opposite(strong);
+    const Square strong_king = lsb(board.pieces(strong, KING));
+    const Square weak_king = lsb(board.pieces(weak, KING));
+    const Square pawn = lsb(board.pieces(strong, PAWN));
+
+    if (!Endgame::kpkWins(strong, strong_king, pawn, weak_king,
+                          board.sideToMove()))
+    {
+      return { Verdict::EXACT, 0 };
+    }
+
+    const int rank = strong == WHITE ? 7 - (pawn >> 3) : pawn >> 3;
+    const Square front = strong == WHITE ? pawn - 8 : pawn + 8;
+    const int score = Endgame::KNOWN_WIN + pieceValue(PAWN) + rank * 20
+                    - distance(strong_king, front) * 5;
+    return forSideToMove(board, strong, Verdict::EXACT, score);
+  }
+
+  /****************************************************************************
+   *
+   * Function: recognizeKXK(board, strong)
+   * - enough to mate a bare king with, drive it to the edge and bring the
+   *   other king up. The search still has to find the mate
+   ***************************************************************************/
+  Verdict recognizeKXK(const BoardManager& board, Color strong)
+  {
+    const Color weak = opposite(strong);
+    const Square strong_king = lsb(board.pieces(strong, KING));
+    const Square weak_king = lsb(board.pieces(weak, KING));
+
+    int score = Endgame::KNOWN_WIN;
+    for (auto t : { KNIGHT, BISHOP, ROOK, QUEEN }) {
+      score += popCount(board.pieces(strong, t)) * pieceValue(t);
+    }
+    score += edgeDistance(weak_king) * 20;
+    score += (7 - distance(strong_king, weak_king)) * 10;
+    return forSideToMove(board, strong, Verdict::EVAL, score);
+  }
+
+  /****************************************************************************
+   *
+   * Function: keyFor(code, strong)
+   * - the material key for a signature written like "KRK", the strong
+   *   side's pieces first
+   ***************************************************************************/
+  uint64_t keyFor(const char* code, Color strong)
+  {
+    uint64_t key = 0;
+    int kings = 0;
+    for (const char* c = code; *c; c++) {
+      PieceType t = NONE;
+      switch (*c) {
+        case 'K': kings++; continue;
+        case 'P': t = PAWN; break;
+        case 'N': t = KNIGHT; break;
+        case 'B': t = BISHOP; break;
+        case 'R': t = ROOK; break;
+        case 'Q': t = QUEEN; break;
+      }
+      const Color side = kings == 1 ? strong : opposite(strong);
+      key += 1ULL << (4 * (side * 5 + t - 1));
+    }
+    return key;
+  }
+
+  // registered for both colors, a signature that reads the same from either
+  // side only needs the one entry
+  void add(const char* code, Recognizer recognize)
+  {
+    for (auto strong : { WHITE, BLACK }) {
+      registry.try_emplace(keyFor(code, strong), Entry { recognize, strong });
+    }
+
+    int pieces = 0;
+    for (const char* c = code; *c; c++) {
+      pieces++;
+    }
+    max_pieces = std::max(max_pieces, pieces);
+  }
+}
+
+/******************************************************************************
+ *
+ * Function: Endgame::init()
+ *
+ *****************************************************************************/
+void Endgame::init()
+{
+  static const bool initialised = [] {
+    buildKPK();
+
+    for (auto code : { "KK", "KNK", "KBK", "KNNK" }) {
+      add(code, recognizeDraw);
+    }
+
+    add("KPK", recognizeKPK);
+
+    for (auto code : { "KQK", "KRK", "KQQK", "KQRK", "KRRK" }) {
+      add(code, recognizeKXK);
+    }
+    return true;
+  }();
+  (void)initialised;
+}
+
+/******************************************************************************
+ *
+ * Function: Endgame::materialKey(const BoardManager&)
+ *
+ *****************************************************************************/
+uint64_t Endgame::materialKey(const BoardManager& board)
+{
+  uint64_t key = 0;
+  for (auto c : { WHITE, BLACK }) {
+    for (auto t : { PAWN, KNIGHT, BISHOP, ROOK, QUEEN }) {
+      const uint64_t count = std::min(popCount(board.pieces(c, t)), 15);
+      key |= count << (4 * (c * 5 + t - 1));
+    }
+  }
+  return key;
+}
+
+/******************************************************************************
+ *
+ * Function: Endgame::probe(const BoardManager&)
+ * - almost every position has too many pieces, that is found from the
+ *   occupancy before the material is counted
+ *****************************************************************************/
+Endgame::Verdict Endgame::probe(const BoardManager& board)
+{
+  if (popCount(board.occupied()) > max_pieces) {
+    return { Verdict::UNKNOWN, 0 };
+  }
+
+  const auto it = registry.find(materialKey(board));
+  if (it == registry.end()) {
+    return { Verdict::UNKNOWN, 0 };
+  }
+  return it->second.recognize(board, it->second.strong);
+}
+
+/******************************************************************************
+ *
+ * Function: Endgame::kpkWins(strong, strong_king, pawn, weak_king, to_move)
+ * - turned around so the pawn is white and on the queen side
+ *****************************************************************************/
+bool Endgame::kpkWins(Color strong, Square strong_king, Square pawn,
+                      Square weak_king, Color to_move)
+{
+  const Color us = to_move == strong ? WHITE : BLACK;
+
+  if (strong == BLACK) {
+    strong_king ^= 56;
+    weak_king ^= 56;
+    pawn ^= 56;
+  }
+
+  if ((pawn & 7) >= 4) {
+    strong_king ^= 7;
+    weak_king ^= 7;
+    pawn ^= 7;
+  }
+
+  const int idx = kpkIndex(us, strong_king, weak_king, pawn);
+  return kpk_bits[idx / 64] >> (idx % 64) & 1;
+}
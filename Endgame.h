@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include "BoardManager.h"
+
+// endings the search cannot be trusted to play on its own. A recognizer is
+// registered for a material signature, the piece counts of both sides, and
+// is asked about any position with exactly that material. King and pawn
+// against king is answered from a bitbase built by retrograde analysis
+namespace Endgame {
+
+  // above anything material gets to, below the mate scores. A side this far
+  // ahead wins, the search just has not found the mate yet
+  constexpr int KNOWN_WIN = 10000;
+
+  struct Verdict {
+    enum Kind : uint8_t {
+      // no recognizer for this material
+      UNKNOWN = 0,
+      // the result is known, the search can stop at the position
+      EXACT = 1,
+      // only a better evaluation, the search goes on
+      EVAL = 2
+    };
+
+    Kind kind;
+    // from the side to move's point of view
+    int score;
+  };
+
+  // builds the bitbase and the registry, only the first call does anything
+  void init();
+
+  // counts of every piece but the kings, four bits each
+  uint64_t materialKey(const BoardManager& board);
+
+  Verdict probe(const BoardManager& board);
+
+  // whether the side with the pawn wins, with the pawn's side to move or
+  // not. Squares are the board's own and either color may have the pawn
+  bool kpkWins(Color strong, Square strong_king, Square pawn,
+               Square weak_king, Color to_move);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <assert.h>
+#include "PackedMove.h"
+
+// fixed capacity list of moves that lives on the stack, no legal chess
+// position has more than 218 moves so generation never has to allocate
+class MoveList {
+  public:
+    static constexpr size_t MAX_MOVES = 256;
+
+    void push_back(PackedMove m) {
+      assert(_size < MAX_MOVES);
+      _moves[_size++] = m;
+    }
+
+    void clear() { _size = 0; }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    PackedMove& operator[](size_t i) { return _moves[i]; }
+    const PackedMove& operator[](size_t i) const { return _moves[i]; }
+
+    PackedMove* begin() { return _moves.data(); }
+    PackedMove* end() { return _moves.data() + _size; }
+    const PackedMove* begin() const { return _moves.data(); }
+    const PackedMove* end() const { return _moves.data() + _size; }
+
+  private:
+    std::array<PackedMove, MAX_MOVES> _moves;
+    size_t _size = 0;
+};
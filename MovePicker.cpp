@@ -0,0 +1,281 @@
+#include "MovePicker.h"
+#include <algorithm>
+#include <cstdlib>
+
+/******************************************************************************
+ *
+ * Method: OrderingTables::newSearch()
+ * - killers only make sense for the position they were found in, the
+ *   history is halved so the last search still counts for something
+ *****************************************************************************/
+void OrderingTables::newSearch()
+{
+  for (auto& k : killers) {
+    k.fill(PackedMove {});
+  }
+
+  for (auto& from : history) {
+    for (auto& to : from) {
+      for (auto& h : to) {
+        h /= 2;
+      }
+    }
+  }
+
+  cutoffs = 0;
+  first_move_cutoffs = 0;
+}
+
+/******************************************************************************
+ *
+ * Method: OrderingTables::update(board, best, ply, depth, quiets, count)
+ * - a quiet move caused a cutoff. The bonus grows with depth and the
+ *   update pulls towards the bound so nothing overflows or saturates
+ *****************************************************************************/
+void OrderingTables::update(const BoardManager& board, PackedMove best,
+                            int ply, int depth, const PackedMove* quiets,
+                            int quiet_count)
+{
+  const auto color = board.sideToMove();
+  const int bonus = std::min(depth * depth, 400);
+
+  auto adjust = [&](PackedMove m, int delta) {
+    auto& h = history[color][m.from()][m.to()];
+    h += delta - h * std::abs(delta) / HISTORY_MAX;
+  };
+
+  adjust(best, bonus);
+  for (int i = 0; i < quiet_count; i++) {
+    if (quiets[i] != best) {
+      adjust(quiets[i], -bonus);
+    }
+  }
+
+  if (ply < MAX_PLY && killers[ply][0] != best) {
+    killers[ply][1] = killers[ply][0];
+    killers[ply][0] = best;
+  }
+
+  const auto previous = board.lastMove();
+  if (previous) {
+    const auto p = board.pieceOn(previous.to());
+    counters[p.color * 6 + p.type - 1][previous.to()] = best;
+  }
+}
+
+/******************************************************************************
+ *
+ * Method: OrderingTables::counterMove(board)
+ *
+ *****************************************************************************/
+PackedMove OrderingTables::counterMove(const BoardManager& board) const
+{
+  const auto previous = board.lastMove();
+  if (!previous) {
+    return PackedMove {};
+  }
+
+  const auto p = board.pieceOn(previous.to());
+  return counters[p.color * 6 + p.type - 1][previous.to()];
+}
+
+/******************************************************************************
+ *
+ * Method: MovePicker::MovePicker(board, moves, tables, tt_move, ply)
+ * - the moves are reordered in place
+ *****************************************************************************/
+MovePicker::MovePicker(const BoardManager& board, MoveList& moves,
+                       const OrderingTables& tables, PackedMove tt_move,
+                       int ply)
+  : _board(board),
+    _moves(moves),
+    _tables(tables),
+    _tt_move(tt_move)
+{
+  if (ply < OrderingTables::MAX_PLY) {
+    _refutations = { tables.killers[ply][0], tables.killers[ply][1],
+                     tables.counterMove(board) };
+  } else {
+    _refutations = { PackedMove {}, PackedMove {},
+                     tables.counterMove(board) };
+  }
+
+  for (size_t i = 0; i < _moves.size(); i++) {
+    if (_moves[i].isCapture() || _moves[i].isPromotion()) {
+      std::swap(_moves[i], _moves[_noisy_end++]);
+    }
+  }
+}
+
+/******************************************************************************
+ *
+ * Method: MovePicker::next()
+ *
+ *****************************************************************************/
+PackedMove MovePicker::next()
+{
+  switch (_stage) {
+    case TT_MOVE:
+      _stage = CAPTURES_INIT;
+      if (_tt_move &&
+          std::find(_moves.begin(), _moves.end(), _tt_move) != _moves.end())
+      {
+        return _tt_move;
+      }
+      _tt_move = PackedMove {};
+      [[fallthrough]];
+
+    case CAPTURES_INIT:
+      for (size_t i = 0; i < _noisy_end; i++) {
+        _scores[i] = captureScore(_moves[i]);
+      }
+      _current = 0;
+      _stage = GOOD_CAPTURES;
+      [[fallthrough]];
+
+    case GOOD_CAPTURES:
+      while (_current < _noisy_end) {
+        selectBest(_current, _noisy_end);
+        if (_scores[_current] < 0) {
+          break;
+        }
+
+        const auto m = _moves[_current++];
+        if (m != _tt_move) {
+          return m;
+        }
+      }
+      _bad_captures = _current;
+
+      // only refutations that are quiet moves in this position and
+      // not already tried are kept, the quiet stage skips those
+      for (size_t i = 0; i < _refutations.size(); i++) {
+        auto& r = _refutations[i];
+        const bool repeat =
+          std::find(_refutations.begin(), _refutations.begin() + i, r) !=
+          _refutations.begin() + i;
+        if (!r || r == _tt_move || repeat || !isQuietMove(r)) {
+          r = PackedMove {};
+        }
+      }
+      _stage = REFUTATIONS;
+      [[fallthrough]];
+
+    case REFUTATIONS:
+      while (_refutation < _refutations.size()) {
+        const auto m = _refutations[_refutation++];
+        if (m) {
+          return m;
+        }
+      }
+      _stage = QUIETS_INIT;
+      [[fallthrough]];
+
+    case QUIETS_INIT:
+    {
+      const auto& history = _tables.history[_board.sideToMove()];
+      for (size_t i = _noisy_end; i < _moves.size(); i++) {
+        _scores[i] = history[_moves[i].from()][_moves[i].to()];
+      }
+      _current = _noisy_end;
+      _stage = QUIETS;
+      [[fallthrough]];
+    }
+
+    case QUIETS:
+      while (_current < _moves.size()) {
+        selectBest(_current, _moves.size());
+        const auto m = _moves[_current++];
+        if (m != _tt_move && !isRefutation(m)) {
+          return m;
+        }
+      }
+      _current = _bad_captures;
+      _stage = BAD_CAPTURES;
+      [[fallthrough]];
+
+    case BAD_CAPTURES:
+      while (_current < _noisy_end) {
+        selectBest(_current, _noisy_end);
+        const auto m = _moves[_current++];
+        if (m != _tt_move) {
+          return m;
+        }
+      }
+      _stage = DONE;
+      [[fallthrough]];
+
+    case DONE:
+    default:
+      return PackedMove {};
+  }
+}
+
+/******************************************************************************
+ *
+ * Method: MovePicker::selectBest(begin, end)
+ * - one step of a selection sort, the best move left goes to begin
+ *****************************************************************************/
+void MovePicker::selectBest(size_t begin, size_t end)
+{
+  size_t best = begin;
+  for (size_t i = begin + 1; i < end; i++) {
+    if (_scores[i] > _scores[best]) {
+      best = i;
+    }
+  }
+  std::swap(_moves[begin], _moves[best]);
+  std::swap(_scores[begin], _scores[best]);
+}
+
+/******************************************************************************
+ *
+ * Method: MovePicker::isQuietMove(PackedMove)
+ * - killers and counter moves come from other positions
+ *****************************************************************************/
+bool MovePicker::isQuietMove(PackedMove m) const
+{
+  return std::find(_moves.begin() + _noisy_end, _moves.end(), m) !=
+         _moves.end();
+}
+
+/******************************************************************************
+ *
+ * Method: MovePicker::isRefutation(PackedMove)
+ *
+ *****************************************************************************/
+bool MovePicker::isRefutation(PackedMove m) const
+{
+  return std::find(_refutations.begin(), _refutations.end(), m) !=
+         _refutations.end();
+}
+
+/******************************************************************************
+ *
+ * Method: MovePicker::captureScore(PackedMove)
+ * - most valuable victim, then least valuable attacker. Captures that
+ *   lose material once the exchange is played out, and promoting to
+ *   anything but a queen, score below zero and wait until the end
+ *****************************************************************************/
+int MovePicker::captureScore(PackedMove m) const
+{
+  const auto attacker = _board.pieceOn(m.from()).type;
+  const auto victim = m.flag() == PackedMove::EN_PASSANT
+    ? PAWN
+    : _board.pieceOn(m.to()).type;
+
+  int score = pieceValue(victim) * 8 - attacker;
+
+  if (m.isPromotion()) {
+    if (m.promotion() != QUEEN) {
+      return score - 100000;
+    }
+    score += pieceValue(QUEEN) * 8;
+  }
+
+  // taking something worth at least the attacker never loses
+  if (pieceValue(attacker) > pieceValue(victim) && _board.see(m) < 0) {
+    return score - 100000;
+  }
+  return score;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "BoardManager.h"
+#include "MoveList.h"
+
+// what a search thread has learned about quiet moves, kept between the
+// nodes of a search and aged between searches
+struct OrderingTables {
+  static constexpr int MAX_PLY = 64;
+  static constexpr int HISTORY_MAX = 16384;
+
+  // two quiet moves per ply that caused a cutoff in a sibling node
+  std::array<std::array<PackedMove, 2>, MAX_PLY> killers {};
+  // the quiet reply that refuted a move, by the piece that made it
+  // (color * 6 + type - 1) and the square it went to
+  std::array<std::array<PackedMove, 64>, 12> counters {};
+  // by color, from and to, raised for quiet moves that cause cutoffs
+  // and lowered for the ones tried before them
+  std::array<std::array<std::array<int, 64>, 64>, 2> history {};
+
+  // how often the first move searched was already good enough
+  uint64_t cutoffs = 0;
+  uint64_t first_move_cutoffs = 0;
+
+  void newSearch();
+  void update(const BoardManager& board, PackedMove best, int ply,
+              int depth, const PackedMove* quiets, int quiet_count);
+  PackedMove counterMove(const BoardManager& board) const;
+};
+
+// hands out the moves of a node one stage at a time, best first:
+// the table move, captures that dont lose material, the killers, the
+// counter move, quiet moves by history, and last the losing captures.
+// Each stage is only scored when it is reached and the best remaining
+// move is selected on demand, so a cutoff on an early move never pays
+// for ordering the rest
+class MovePicker {
+  public:
+    MovePicker(const BoardManager& board, MoveList& moves,
+               const OrderingTables& tables, PackedMove tt_move, int ply);
+
+    // the null move once every move has been handed out
+    PackedMove next();
+
+  private:
+    enum Stage : uint8_t {
+      TT_MOVE,
+      CAPTURES_INIT,
+      GOOD_CAPTURES,
+      REFUTATIONS,
+      QUIETS_INIT,
+      QUIETS,
+      BAD_CAPTURES,
+      DONE
+    };
+
+    const BoardManager& _board;
+    MoveList& _moves;
+    const OrderingTables& _tables;
+    std::array<int, MoveList::MAX_MOVES> _scores;
+
+    PackedMove _tt_move;
+    // killers then the counter move
+    std::array<PackedMove, 3> _refutations;
+    size_t _refutation = 0;
+
+    Stage _stage = TT_MOVE;
+    // captures and promotions are moved in front of the quiet moves
+    size_t _noisy_end = 0;
+    size_t _current = 0;
+    size_t _bad_captures = 0;
+
+    void selectBest(size_t begin, size_t end);
+    bool isQuietMove(PackedMove m) const;
+    bool isRefutation(PackedMove m) const;
+    int captureScore(PackedMove m) const;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "BoardManager.h"
+
+// opening moves by position hash in the Polyglot format: 16 byte big
+// endian entries of key, move, weight and learn, sorted by Polyglot key, so
+// books made by other tools work as well as makebook's. The file is mapped
+// rather than read so opening it parses nothing, and a probe is a binary
+// search straight over the mapping that allocates nothing
+class OpeningBook {
+  public:
+    struct Entry {
+      uint64_t key;
+      uint16_t move;
+      uint16_t weight;
+      uint32_t learn;
+    };
+
+    static constexpr size_t ENTRY_SIZE = 16;
+
+    OpeningBook() = default;
+    ~OpeningBook();
+
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    // false when the file is missing or not a whole number of entries,
+    // the book is left empty then
+    bool open(const std::string& path);
+    void close();
+
+    bool loaded() const { return _count > 0; }
+    size_t size() const { return _count; }
+
+    // one of the position's book moves, picked at random in proportion to
+    // the weights. Null when the position is not in the book
+    PackedMove probe(BoardManager& board);
+
+    // the position's hash with Polyglot's keys, what book entries are
+    // sorted and looked up by
+    static uint64_t polyglotKey(const BoardManager& board);
+
+    // Polyglot move encoding: to file, to rank, from file, from rank in
+    // three bits each from the bottom, then the promotion piece. Castling
+    // is written as the king taking its own rook
+    static uint16_t encode(PackedMove m);
+    // the legal move with that encoding, null if there is none
+    static PackedMove decode(BoardManager& board, uint16_t move);
+
+    static void write(unsigned char* out, const Entry& e);
+
+  private:
+    const unsigned char* _data = nullptr;
+    size_t _bytes = 0;
+    size_t _count = 0;
+    // mapped files are unmapped on close, anything else was read in
+    bool _mapped = false;
+    uint64_t _random = 0;
+
+    Entry entryAt(size_t i) const;
+    uint64_t keyAt(size_t i) const;
+    // index of the first entry with this key, or _count
+    size_t lowerBound(uint64_t key) const;
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "common_enums.h"
+#include "Bitboard.h"
+
+// a move in 16 bits, 6 for each square and 4 for what kind of move it is,
+// so do_move never has to work the type out again from the squares
+//
+//   bits 0-5   from
+//   bits 6-11  to
+//   bits 12-15 flag
+class PackedMove {
+  public:
+    enum Flag : uint8_t {
+      QUIET = 0,
+      DOUBLE_PUSH = 1,
+      KING_CASTLE = 2,
+      QUEEN_CASTLE = 3,
+      CAPTURE = 4,
+      EN_PASSANT = 5,
+      // the low two bits pick the piece, knight, bishop, rook or queen
+      PROMOTION = 8,
+      PROMOTION_CAPTURE = 12
+    };
+
+    // trivial so a MoveList doesnt pay to clear its storage,
+    // PackedMove {} is the null move
+    PackedMove() = default;
+
+    constexpr PackedMove(Square from, Square to, uint8_t flag = QUIET)
+      : _data(uint16_t(from | (to << 6) | (flag << 12)))
+    {}
+
+    constexpr Square from() const { return _data & 0x3F; }
+    constexpr Square to() const { return (_data >> 6) & 0x3F; }
+    constexpr uint8_t flag() const { return _data >> 12; }
+
+    constexpr bool isCapture() const { return flag() & CAPTURE; }
+    constexpr bool isPromotion() const { return flag() & PROMOTION; }
+    constexpr bool isCastle() const {
+      return flag() == KING_CASTLE || flag() == QUEEN_CASTLE;
+    }
+
+    constexpr PieceType promotion() const {
+      return isPromotion() ? PieceType(KNIGHT + (flag() & 3)) : NONE;
+    }
+
+    // the promotion flag for the piece, with or without a capture
+    static constexpr uint8_t promotionFlag(PieceType t, bool capture) {
+      return (capture ? PROMOTION_CAPTURE : PROMOTION) | (t - KNIGHT);
+    }
+
+    constexpr uint16_t raw() const { return _data; }
+    static constexpr PackedMove fromRaw(uint16_t raw) {
+      PackedMove m {};
+      m._data = raw;
+      return m;
+    }
+    constexpr explicit operator bool() const { return _data != 0; }
+    constexpr bool operator==(const PackedMove& other) const = default;
+
+  private:
+    uint16_t _data;
+};
+
+static_assert(sizeof(PackedMove) == 2);
+
+// the UI still works in grid coordinates
+constexpr Move toMove(PackedMove m)
+{
+  return Move { toPoint(m.from()), toPoint(m.to()), m.promotion() };
+}
+
+// long algebraic, e2e4 or e7e8q
+inline std::string moveToString(PackedMove m)
+{
+  std::string s;
+  s += (char)('a' + (m.from() & 7));
+  s += (char)('8' - (m.from() >> 3));
+  s += (char)('a' + (m.to() & 7));
+  s += (char)('8' - (m.to() >> 3));
+
+  switch (m.promotion()) {
+    case QUEEN:
+      s += 'q';
+      break;
+    case ROOK:
+      s += 'r';
+      break;
+    case BISHOP:
+      s += 'b';
+      break;
+    case KNIGHT:
+      s += 'n';
+      break;
+    default:
+      break;
+  }
+  return s;
+}
@@ -0,0 +1,224 @@
+#include "Perft.h"
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+  // the moves from the root to where a worker starts counting
+  struct Task {
+    PackedMove moves[2];
+    int length = 0;
+    size_t root = 0;
+  };
+
+  // one deque per worker, the owner takes from the front and idle
+  // workers steal from the back. Every task exists before the workers
+  // start, so finding all the deques empty means the work is done
+  class WorkStealingQueues {
+    public:
+      explicit WorkStealingQueues(size_t workers)
+        : _queues(workers)
+      {}
+
+      void push(size_t worker, const Task& t) {
+        _queues[worker].tasks.push_back(t);
+      }
+
+      bool pop(size_t worker, Task& t) {
+        auto& own = _queues[worker];
+        {
+          std::lock_guard<std::mutex> lock(own.mutex);
+          if (!own.tasks.empty()) {
+            t = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+          }
+        }
+
+        for (size_t i = 1; i < _queues.size(); i++) {
+          auto& victim = _queues[(worker + i) % _queues.size()];
+          std::lock_guard<std::mutex> lock(victim.mutex);
+          if (!victim.tasks.empty()) {
+            t = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+          }
+        }
+        return false;
+      }
+
+    private:
+      struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+      };
+
+      std::vector<Queue> _queues;
+  };
+}
+
+/******************************************************************************
+ *
+ * Method: Perft::HashTable::HashTable(size_t mb)
+ * - the entry count is rounded down to a power of two
+ *****************************************************************************/
+Perft::HashTable::HashTable(size_t mb)
+{
+  size_t count = 1;
+  while (count * 2 * sizeof(Entry) <= mb * 1024 * 1024) {
+    count *= 2;
+  }
+
+  _entries = std::make_unique<Entry[]>(count);
+  _mask = count - 1;
+}
+
+/******************************************************************************
+ *
+ * Method: Perft::HashTable::probe(key, depth, nodes)
+ *
+ *****************************************************************************/
+bool Perft::HashTable::probe(uint64_t key, int depth, uint64_t& nodes) const
+{
+  const auto k = mix(key, depth);
+  const auto& e = _entries[k & _mask];
+  const auto stored = e.nodes.load(std::memory_order_relaxed);
+
+  if ((e.check.load(std::memory_order_relaxed) ^ stored) == k) {
+    nodes = stored;
+    return true;
+  }
+  return false;
+}
+
+/******************************************************************************
+ *
+ * Method: Perft::HashTable::store(key, depth, nodes)
+ *
+ *****************************************************************************/
+void Perft::HashTable::store(uint64_t key, int depth, uint64_t nodes)
+{
+  const auto k = mix(key, depth);
+  auto& e = _entries[k & _mask];
+
+  e.check.store(k ^ nodes, std::memory_order_relaxed);
+  e.nodes.store(nodes, std::memory_order_relaxed);
+}
+
+/******************************************************************************
+ *
+ * Function: Perft::count(BoardManager&, int, HashTable*)
+ * - the moves at the last ply are counted, not played
+ *****************************************************************************/
+uint64_t Perft::count(BoardManager& game, int depth, HashTable* hash)
+{
+  if (depth <= 0) {
+    return 1;
+  }
+
+  const auto moves = game.genLegal(game.sideToMove());
+  if (depth == 1) {
+    return moves.size();
+  }
+
+  uint64_t nodes = 0;
+  if (hash && hash->probe(game.key(), depth, nodes)) {
+    return nodes;
+  }
+
+  for (auto m : moves) {
+    game.makeMove(m);
+    nodes += count(game, depth - 1, hash);
+    game.unmakeMove();
+  }
+
+  if (hash) {
+    hash->store(game.key(), depth, nodes);
+  }
+  return nodes;
+}
+
+/******************************************************************************
+ *
+ * Function: Perft::divide(BoardManager&, int)
+ *
+ *****************************************************************************/
+std::vector<Perft::Divide> Perft::divide(BoardManager& game, int depth)
+{
+  std::vector<Divide> result;
+  for (auto m : game.genLegal(game.sideToMove())) {
+    game.makeMove(m);
+    result.push_back({m, count(game, depth - 1)});
+    game.unmakeMove();
+  }
+  return result;
+}
+
+/******************************************************************************
+ *
+ * Function: Perft::divide(BoardManager&, int, const Options&)
+ *
+ * - root moves alone are too few to keep many cores busy, so below
+ *   depth 3 every root move is a task and above it every reply is
+ *****************************************************************************/
+std::vector<Perft::Divide> Perft::divide(BoardManager& game, int depth,
+                                         const Options& options)
+{
+  const auto workers = size_t(std::max(1, options.threads));
+  std::unique_ptr<HashTable> hash;
+  if (options.hash_mb > 0) {
+    hash = std::make_unique<HashTable>(options.hash_mb);
+  }
+
+  std::vector<Divide> result;
+  WorkStealingQueues queues(workers);
+  size_t next_worker = 0;
+
+  for (auto m : game.genLegal(game.sideToMove())) {
+    const auto root = result.size();
+    result.push_back({m, 0});
+
+    if (depth < 3) {
+      queues.push(next_worker++ % workers, Task{ {m}, 1, root });
+      continue;
+    }
+
+    game.makeMove(m);
+    for (auto reply : game.genLegal(game.sideToMove())) {
+      queues.push(next_worker++ % workers, Task{ {m, reply}, 2, root });
+    }
+    game.unmakeMove();
+  }
+
+  std::vector<std::atomic<uint64_t>> counts(result.size());
+  std::vector<std::thread> threads;
+
+  for (size_t w = 0; w < workers; w++) {
+    threads.emplace_back([&, w] {
+      BoardManager board = game;
+      Task t;
+      while (queues.pop(w, t)) {
+        for (int i = 0; i < t.length; i++) {
+          board.makeMove(t.moves[i]);
+        }
+
+        counts[t.root] += count(board, depth - t.length, hash.get());
+
+        for (int i = 0; i < t.length; i++) {
+          board.unmakeMove();
+        }
+      }
+    });
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  for (size_t i = 0; i < result.size(); i++) {
+    result[i].nodes = counts[i].load();
+  }
+  return result;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "BoardManager.h"
+
+// move path enumeration, counts the leaf nodes of the legal move tree
+// to check the move generator against known results
+namespace Perft {
+
+  struct Divide {
+    PackedMove move;
+    uint64_t nodes;
+  };
+
+  struct Options {
+    int threads = 1;
+    // 0 turns the hash table off
+    size_t hash_mb = 0;
+  };
+
+  // subtree counts keyed by position hash and depth, shared between
+  // threads without locks, an entry stores the key xor'ed with the count
+  // so a torn write from two threads fails the check instead of being used
+  class HashTable {
+    public:
+      explicit HashTable(size_t mb);
+
+      bool probe(uint64_t key, int depth, uint64_t& nodes) const;
+      void store(uint64_t key, int depth, uint64_t nodes);
+
+    private:
+      struct Entry {
+        std::atomic<uint64_t> check {0};
+        std::atomic<uint64_t> nodes {0};
+      };
+
+      std::unique_ptr<Entry[]> _entries;
+      size_t _mask = 0;
+
+      static uint64_t mix(uint64_t key, int depth) {
+        return key ^ (uint64_t(depth) * 0x9E3779B97F4A7C15ULL);
+      }
+  };
+
+  uint64_t count(BoardManager& game, int depth, HashTable* hash = nullptr);
+
+  // node count below every root move
+  std::vector<Divide> divide(BoardManager& game, int depth);
+
+  // the same, with the first two plies split into tasks for a work
+  // stealing pool of options.threads threads
+  std::vector<Divide> divide(BoardManager& game, int depth,
+                             const Options& options);
+}
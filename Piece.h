@@ -1,75 +1,39 @@
 #pragma once
 
-#include <string>
+#include <type_traits>
 #include "common_enums.h"
 
+// a piece is only its type and color, where it stands is given by
+// its index in the board, so a whole board is 64 bytes
 class Piece {
 
-  private:
-    std::string prefixPath = "resources/";
-
   public:
 
-    std::string icon = "";
-    Color color = C_NONE;
-    PieceType type = NONE;
-    bool has_moved = false;
-
-    int x = 0;
-    int y = 0;
-    int prev_x = 0;
-    int prev_y = 0;
+    PieceType type : 4 = NONE;
+    Color color : 4 = C_NONE;
 
     Piece() = default;
 
-    // this is trivially copyable, but just in case
-    Piece(const Piece& other) {
-      x = other.x;
-      y = other.y;
-      prev_x = other.prev_x;
-      prev_y = other.prev_y;
-      type = other.type;
-      color = other.color;
-      icon = other.icon;
-      has_moved = other.has_moved;
-    }
-
-    Piece(int x, int y)
-      : x(x),
-        y(y)
-    {}
-
-    Piece(int new_x, int new_y, PieceType type)
-      : x(new_x),
-        y(new_y),
-        prev_x(x),
-        prev_y(y),
-        type(type)
+    constexpr Piece(PieceType type, Color color)
+      : type(type),
+        color(color)
     {}
 
-    Piece(int new_x, int new_y, PieceType type, Color color)
-      : x(new_x),
-        y(new_y),
-        prev_x(x),
-        prev_y(y),
-        type(type),
-        color(color)
-    {
-      icon = prefixPath + typeToString() + "_" + colorToString() + ".png";
-    }
-      
     explicit operator bool() const  {
       return type != NONE;
     }
 
-    const auto Icon() { return icon.c_str(); };
+    void Clear() { type = NONE; color = C_NONE; }
 
-    const Color Color() const { return color; };
-      
-    void Clear() { type = NONE; color = C_NONE; x = -1; y = -1;}
+    char typeToFEN() const;
+};
 
-    std::string typeToString();
-    std::string typeToFEN() const ;
+// material in centipawns, the king is never traded so it has none
+constexpr int pieceValue(PieceType t)
+{
+  constexpr int values[] = { 0, 100, 300, 300, 500, 900, 0 };
+  return values[t];
+}
 
-    std::string colorToString();
-};
+static_assert(sizeof(Piece) == 1);
+static_assert(std::is_trivially_copyable_v<Piece>);
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <array>
+#include "Bitboard.h"
+#include "Piece.h"
+
+// material and piece square tables, one for the middlegame and one for the
+// endgame, blended by how much material is left. The board keeps the sum
+// for every piece on it up to date as pieces come and go, so evaluating a
+// position never has to look at the pieces. Built at compile time like the
+// zobrist keys
+namespace Psqt {
+
+  struct Score {
+    int mg;
+    int eg;
+
+    constexpr Score& operator+=(const Score& o) {
+      mg += o.mg;
+      eg += o.eg;
+      return *this;
+    }
+    constexpr Score& operator-=(const Score& o) {
+      mg -= o.mg;
+      eg -= o.eg;
+      return *this;
+    }
+    constexpr bool operator==(const Score& o) const = default;
+  };
+
+  // what each piece adds to the game phase, the starting position is
+  // PHASE_MAX and bare kings are 0
+  constexpr int phaseWeight(PieceType t)
+  {
+    constexpr int weights[] = { 0, 0, 1, 1, 2, 4, 0 };
+    return weights[t];
+  }
+  constexpr int PHASE_MAX = 24;
+
+  // middlegame and endgame scores mixed by the phase, past PHASE_MAX after
+  // a promotion counts as a full middlegame
+  constexpr int blend(const Score& s, int phase)
+  {
+    phase = phase < PHASE_MAX ? phase : PHASE_MAX;
+    return (s.mg * phase + s.eg * (PHASE_MAX - phase)) / PHASE_MAX;
+  }
+
+  // pawns and rooks are worth more with the board empty, knights less
+  constexpr Score material(PieceType t)
+  {
+    constexpr Score values[] = { {0, 0}, {100, 120}, {300, 280}, {300, 300},
+                                 {500, 520}, {900, 880}, {0, 0} };
+    return values[t];
+  }
+
+  using Table = std::array<int, 64>;
+
+  // written for white with a8 first, the way the board is laid out,
+  // black reads them upside down
+  namespace Tables {
+
+    // pawns never stand on the last rank
+    constexpr Table pawn_mg = {
+        0,  0,  0,  0,  0,  0,  0,  0,
+       50, 50, 50, 50, 50, 50, 50, 50,
+       10, 10, 20, 30, 30, 20, 10, 10,
+        5,  5, 10, 25, 25, 10,  5,  5,
+        0,  0,  0, 20, 20,  0,  0,  0,
+        5, -5,-10,  0,  0,-10, -5,  5,
+        5, 10, 10,-20,-20, 10, 10,  5,
+        0,  0,  0,  0,  0,  0,  0,  0
+    };
+
+    // with the pieces gone a pawn is worth what it takes to stop it
+    constexpr Table pawn_eg = {
+        0,  0,  0,  0,  0,  0,  0,  0,
+       90, 90, 90, 90, 90, 90, 90, 90,
+       50, 50, 50, 50, 50, 50, 50, 50,
+       30, 30, 30, 30, 30, 30, 30, 30,
+       15, 15, 15, 15, 15, 15, 15, 15,
+        5,  5,  5,  5,  5,  5,  5,  5,
+        0,  0,  0,  0,  0,  0,  0,  0,
+        0,  0,  0,  0,  0,  0,  0,  0
+    };
+
+    constexpr Table knight_mg = {
+      -50,-40,-30,-30,-30,-30,-40,-50,
+      -40,-20,  0,  0,  0,  0,-20,-40,
+      -30,  0, 10, 15, 15, 10,  0,-30,
+      -30,  5, 15, 20, 20, 15,  5,-30,
+      -30,  0, 15, 20, 20, 15,  0,-30,
+      -30,  5, 10, 15, 15, 10,  5,-30,
+      -40,-20,  0,  5,  5,  0,-20,-40,
+      -50,-40,-30,-30,-30,-30,-40,-50
+    };
+
+    // still better central, but nothing left to develop
+    constexpr Table knight_eg = {
+      -40,-30,-20,-20,-20,-20,-30,-40,
+      -30,-15, -5,  0,  0, -5,-15,-30,
+      -20, -5,  5, 10, 10,  5, -5,-20,
+      -20,  0, 10, 15, 15, 10,  0,-20,
+      -20,  0, 10, 15, 15, 10,  0,-20,
+      -20, -5,  5, 10, 10,  5, -5,-20,
+      -30,-15, -5,  0,  0, -5,-15,-30,
+      -40,-30,-20,-20,-20,-20,-30,-40
+    };
+
+    constexpr Table bishop_mg = {
+      -20,-10,-10,-10,-10,-10,-10,-20,
+      -10,  0,  0,  0,  0,  0,  0,-10,
+      -10,  0,  5, 10, 10,  5,  0,-10,
+      -10,  5,  5, 10, 10,  5,  5,-10,
+      -10,  0, 10, 10, 10, 10,  0,-10,
+      -10, 10, 10, 10, 10, 10, 10,-10,
+      -10,  5,  0,  0,  0,  0,  5,-10,
+      -20,-10,-10,-10,-10,-10,-10,-20
+    };
+
+    constexpr Table bishop_eg = {
+      -15,-10,-10, -5, -5,-10,-10,-15,
+      -10, -5,  0,  0,  0,  0, -5,-10,
+      -10,  0,  5,  5,  5,  5,  0,-10,
+       -5,  0,  5, 10, 10,  5,  0, -5,
+       -5,  0,  5, 10, 10,  5,  0, -5,
+      -10,  0,  5,  5,  5,  5,  0,-10,
+      -10, -5,  0,  0,  0,  0, -5,-10,
+      -15,-10,-10, -5, -5,-10,-10,-15
+    };
+
+    constexpr Table rook_mg = {
+        0,  0,  0,  0,  0,  0,  0,  0,
+        5, 10, 10, 10, 10, 10, 10,  5,
+       -5,  0,  0,  0,  0,  0,  0, -5,
+       -5,  0,  0,  0,  0,  0,  0, -5,
+       -5,  0,  0,  0,  0,  0,  0, -5,
+       -5,  0,  0,  0,  0,  0,  0, -5,
+       -5,  0,  0,  0,  0,  0,  0, -5,
+        0,  0,  0,  5,  5,  0,  0,  0
+    };
+
+    // the seventh rank still counts, the back rank no longer needs it
+    constexpr Table rook_eg = {
+        0,  0,  0,  0,  0,  0,  0,  0,
+       10, 10, 10, 10, 10, 10, 10, 10,
+        0,  0,  0,  0,  0,  0,  0,  0,
+        0,  0,  0,  0,  0,  0,  0,  0,
+        0,  0,  0,  0,  0,  0,  0,  0,
+        0,  0,  0,  0,  0,  0,  0,  0,
+        0,  0,  0,  0,  0,  0,  0,  0,
+        0,  0,  0,  0,  0,  0,  0,  0
+    };
+
+    // out early it only gets chased
+    constexpr Table queen_mg = {
+      -20,-10,-10, -5, -5,-10,-10,-20,
+      -10,  0,  0,  0,  0,  0,  0,-10,
+      -10,  0,  5,  5,  5,  5,  0,-10,
+       -5,  0,  5,  5,  5,  5,  0, -5,
+        0,  0,  5,  5,  5,  5,  0, -5,
+      -10,  5,  5,  5,  5,  5,  0,-10,
+      -10,  0,  5,  0,  0,  0,  0,-10,
+      -20,-10,-10, -5, -5,-10,-10,-20
+    };
+
+    // in the middle it reaches everything
+    constexpr Table queen_eg = {
+      -30,-20,-10,-10,-10,-10,-20,-30,
+      -20,-10,  0,  5,  5,  0,-10,-20,
+      -10,  0, 10, 15, 15, 10,  0,-10,
+      -10,  5, 15, 20, 20, 15,  5,-10,
+      -10,  5, 15, 20, 20, 15,  5,-10,
+      -10,  0, 10, 15, 15, 10,  0,-10,
+      -20,-10,  0,  5,  5,  0,-10,-20,
+      -30,-20,-10,-10,-10,-10,-20,-30
+    };
+
+    // behind the pawns while there is anything to attack it with
+    constexpr Table king_mg = {
+      -30,-40,-40,-50,-50,-40,-40,-30,
+      -30,-40,-40,-50,-50,-40,-40,-30,
+      -30,-40,-40,-50,-50,-40,-40,-30,
+      -30,-40,-40,-50,-50,-40,-40,-30,
+      -20,-30,-30,-40,-40,-30,-30,-20,
+      -10,-20,-20,-20,-20,-20,-20,-10,
+       20, 20,  0,  0,  0,  0, 20, 20,
+       20, 30, 10,  0,  0, 10, 30, 20
+    };
+
+    // and in the middle once there isnt
+    constexpr Table king_eg = {
+      -50,-40,-30,-20,-20,-30,-40,-50,
+      -30,-20,-10,  0,  0,-10,-20,-30,
+      -30,-10, 20, 30, 30, 20,-10,-30,
+      -30,-10, 30, 40, 40, 30,-10,-30,
+      -30,-10, 30, 40, 40, 30,-10,-30,
+      -30,-10, 20, 30, 30, 20,-10,-30,
+      -30,-30,  0,  0,  0,  0,-30,-30,
+      -50,-30,-30,-30,-30,-30,-30,-50
+    };
+  }
+
+  // indexed like the piece bitboards, color * 6 + type - 1. Material is
+  // added in and black's entries are negative, so the sum over the board
+  // is the score from white's point of view
+  constexpr std::array<std::array<Score, 64>, 12> generate()
+  {
+    const Table* mg[] = { &Tables::pawn_mg, &Tables::knight_mg,
+                          &Tables::bishop_mg, &Tables::rook_mg,
+                          &Tables::queen_mg, &Tables::king_mg };
+    const Table* eg[] = { &Tables::pawn_eg, &Tables::knight_eg,
+                          &Tables::bishop_eg, &Tables::rook_eg,
+                          &Tables::queen_eg, &Tables::king_eg };
+
+    std::array<std::array<Score, 64>, 12> table {};
+    for (int t = 0; t < 6; t++) {
+      const Score value = material(PieceType(t + 1));
+      for (Square s = 0; s < 64; s++) {
+        table[t][s] = { value.mg + (*mg[t])[s], value.eg + (*eg[t])[s] };
+        table[6 + t][s] = { -value.mg - (*mg[t])[s ^ 56],
+                            -value.eg - (*eg[t])[s ^ 56] };
+      }
+    }
+    return table;
+  }
+
+  inline constexpr auto table = generate();
+
+  constexpr Score score(Color c, PieceType t, Square s)
+  {
+    return table[c * 6 + t - 1][s];
+  }
+}
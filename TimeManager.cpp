@@ -0,0 +1,32 @@
+#include "TimeManager.h"
+#include <algorithm>
+
+/******************************************************************************
+ *
+ * Method: TimeManager::start(const Clock&)
+ * - without a fixed move time every move gets an even share of what is
+ *   left, assuming 30 more moves in sudden death, plus most of the
+ *   increment. The search may run over that up to three times, but never
+ *   past half the clock unless this is the last move before the control
+ *****************************************************************************/
+void TimeManager::start(const Clock& clock)
+{
+  _start = std::chrono::steady_clock::now();
+  _active = clock.move_time > 0 || clock.time_left > 0;
+
+  if (clock.move_time > 0) {
+    _optimum = std::max<int64_t>(clock.move_time - OVERHEAD, 1);
+    _maximum = _optimum;
+    return;
+  }
+
+  const int64_t left = std::max<int64_t>(clock.time_left - OVERHEAD, 1);
+  const int moves = clock.moves_to_go > 0 ? std::min(clock.moves_to_go, 40)
+                                          : 30;
+  const int64_t cap = moves == 1 ? left : left / 2;
+
+  _maximum = std::min((left / moves + clock.increment * 3 / 4) * 3, cap);
+  _optimum = std::min(left / moves + clock.increment * 3 / 4, _maximum);
+  _maximum = std::max<int64_t>(_maximum, 1);
+  _optimum = std::max<int64_t>(_optimum, 1);
+}
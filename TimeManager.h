@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// splits the time left on the clock between the moves still to play.
+// The search stops starting new depths once it is past the optimum and
+// stops whatever it is doing at the maximum
+class TimeManager {
+  public:
+    // all in milliseconds, anything left at 0 is not used
+    struct Clock {
+      int64_t time_left;
+      int64_t increment;
+      // moves until the next time control, 0 for the rest of the game
+      int moves_to_go;
+      // a fixed time for this move, the others are ignored
+      int64_t move_time;
+    };
+
+    // kept back for passing the move on and joining the search threads
+    static constexpr int64_t OVERHEAD = 20;
+
+    void start(const Clock& clock);
+    void clear() { _active = false; }
+
+    bool active() const { return _active; }
+    int64_t optimum() const { return _optimum; }
+    int64_t maximum() const { return _maximum; }
+
+    int64_t elapsed() const {
+      return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - _start).count();
+    }
+
+  private:
+    std::chrono::steady_clock::time_point _start;
+    int64_t _optimum = 0;
+    int64_t _maximum = 0;
+    bool _active = false;
+};
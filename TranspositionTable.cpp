@@ -0,0 +1,216 @@
+#include "TranspositionTable.h"
+#include <climits>
+#include <cstdlib>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+/******************************************************************************
+ *
+ * Method: TranspositionTable::TranspositionTable(size_t mb, bool)
+ *
+ *****************************************************************************/
+TranspositionTable::TranspositionTable(size_t mb, bool huge_pages)
+  : _huge_pages(huge_pages)
+{
+  allocate(mb);
+}
+
+/******************************************************************************
+ *
+ * Method: TranspositionTable::~TranspositionTable()
+ *
+ *****************************************************************************/
+TranspositionTable::~TranspositionTable()
+{
+  release();
+}
+
+/******************************************************************************
+ *
+ * Method: TranspositionTable::resize(size_t mb)
+ * - throws every entry away, not safe while a search is running
+ *****************************************************************************/
+void TranspositionTable::resize(size_t mb)
+{
+  release();
+  allocate(mb);
+}
+
+/******************************************************************************
+ *
+ * Method: TranspositionTable::allocate(size_t mb)
+ * - the bucket count is rounded down to a power of two. With huge pages
+ *   a hugetlb mapping is tried first, then transparent huge pages are
+ *   asked for on a 2MB aligned block
+ *****************************************************************************/
+void TranspositionTable::allocate(size_t mb)
+{
+  size_t count = 1;
+  while (count * 2 * sizeof(Bucket) <= mb * 1024 * 1024) {
+    count *= 2;
+  }
+
+  _bytes = count * sizeof(Bucket);
+  _mask = count - 1;
+  _size_mb = _bytes / (1024 * 1024);
+  _mapped = false;
+
+  void* memory = nullptr;
+
+#ifdef __linux__
+  constexpr size_t huge_page = 2 * 1024 * 1024;
+  if (_huge_pages && _bytes >= huge_page) {
+    memory = mmap(nullptr, _bytes, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (memory == MAP_FAILED) {
+      memory = nullptr;
+    } else {
+      _mapped = true;
+    }
+
+    if (!memory) {
+      memory = std::aligned_alloc(huge_page, _bytes);
+      if (memory) {
+        madvise(memory, _bytes, MADV_HUGEPAGE);
+      }
+    }
+  }
+#endif
+
+  if (!memory) {
+    memory = std::aligned_alloc(alignof(Bucket), _bytes);
+  }
+  if (!memory) {
+    throw std::bad_alloc();
+  }
+
+  _buckets = static_cast<Bucket*>(memory);
+  for (size_t i = 0; i < count; i++) {
+    new (&_buckets[i]) Bucket {};
+  }
+}
+
+/******************************************************************************
+ *
+ * Method: TranspositionTable::release()
+ *
+ *****************************************************************************/
+void TranspositionTable::release()
+{
+  if (!_buckets) {
+    return;
+  }
+
+#ifdef __linux__
+  if (_mapped) {
+    munmap(_buckets, _bytes);
+    _buckets = nullptr;
+    return;
+  }
+#endif
+
+  std::free(_buckets);
+  _buckets = nullptr;
+}
+
+/******************************************************************************
+ *
+ * Method: TranspositionTable::clear()
+ *
+ *****************************************************************************/
+void TranspositionTable::clear()
+{
+  for (size_t i = 0; i <= _mask; i++) {
+    for (auto& slot : _buckets[i].slots) {
+      slot.check.store(0, std::memory_order_relaxed);
+      slot.data.store(0, std::memory_order_relaxed);
+    }
+  }
+  _age = 0;
+}
+
+/******************************************************************************
+ *
+ * Method: TranspositionTable::probe(key, entry)
+ *
+ *****************************************************************************/
+bool TranspositionTable::probe(uint64_t key, Entry& entry) const
+{
+  const auto& bucket = _buckets[key & _mask];
+
+  for (const auto& slot : bucket.slots) {
+    const auto data = slot.data.load(std::memory_order_relaxed);
+    if (data && (slot.check.load(std::memory_order_relaxed) ^ data) == key) {
+      entry.move = moveOf(data);
+      entry.score = scoreOf(data);
+      entry.depth = depthOf(data);
+      entry.bound = boundOf(data);
+      return true;
+    }
+  }
+  return false;
+}
+
+/******************************************************************************
+ *
+ * Method: TranspositionTable::store(key, depth, bound, score, move)
+ * - the same position is always overwritten, keeping its old move if the
+ *   new result has none. Otherwise the slot with the shallowest result
+ *   goes, where every search since it was written counts against it
+ *****************************************************************************/
+void TranspositionTable::store(uint64_t key, int depth, Bound bound,
+                               int score, PackedMove move)
+{
+  auto& bucket = _buckets[key & _mask];
+
+  Slot* victim = &bucket.slots[0];
+  int worst = INT_MAX;
+
+  for (auto& slot : bucket.slots) {
+    const auto data = slot.data.load(std::memory_order_relaxed);
+    if (!data) {
+      victim = &slot;
+      break;
+    }
+
+    if ((slot.check.load(std::memory_order_relaxed) ^ data) == key) {
+      if (!move) {
+        move = moveOf(data);
+      }
+      victim = &slot;
+      break;
+    }
+
+    const int value = depthOf(data) - 8 * ((_age - ageOf(data)) & AGE_MASK);
+    if (value < worst) {
+      worst = value;
+      victim = &slot;
+    }
+  }
+
+  const auto data = pack(move, score, depth < 0 ? 0 : depth, bound, _age);
+  victim->check.store(key ^ data, std::memory_order_relaxed);
+  victim->data.store(data, std::memory_order_relaxed);
+}
+
+/******************************************************************************
+ *
+ * Method: TranspositionTable::hashfull()
+ * - sampled from the first thousand slots
+ *****************************************************************************/
+int TranspositionTable::hashfull() const
+{
+  int used = 0;
+  int seen = 0;
+  for (size_t i = 0; i <= _mask && seen < 1000; i++) {
+    for (const auto& slot : _buckets[i].slots) {
+      const auto data = slot.data.load(std::memory_order_relaxed);
+      used += data && ageOf(data) == _age;
+      seen++;
+    }
+  }
+  return seen ? used * 1000 / seen : 0;
+}
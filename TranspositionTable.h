@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "PackedMove.h"
+
+// search results by position hash, shared between search threads without
+// locks. Each slot keeps the key xor'ed with its data, so a slot torn by
+// two threads writing at once fails the check on the next probe instead
+// of handing back another position's score
+class TranspositionTable {
+  public:
+    // what the stored score says about the real one
+    enum Bound : uint8_t {
+      NO_BOUND = 0,
+      UPPER = 1,
+      LOWER = 2,
+      EXACT = 3
+    };
+
+    struct Entry {
+      PackedMove move;
+      int score;
+      int depth;
+      Bound bound;
+    };
+
+    // huge pages are asked for on linux and quietly skipped without them
+    explicit TranspositionTable(size_t mb, bool huge_pages = true);
+    ~TranspositionTable();
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    void resize(size_t mb);
+    void clear();
+
+    // entries from earlier searches are the first to be replaced
+    void newSearch() { _age = (_age + 1) & AGE_MASK; }
+
+    bool probe(uint64_t key, Entry& entry) const;
+    void store(uint64_t key, int depth, Bound bound, int score,
+               PackedMove move);
+
+    // slots out of a thousand holding something from this search
+    int hashfull() const;
+    size_t sizeMB() const { return _size_mb; }
+
+  private:
+    static constexpr size_t SLOTS = 4;
+    static constexpr uint8_t AGE_MASK = 0x3F;
+
+    struct Slot {
+      std::atomic<uint64_t> check;
+      std::atomic<uint64_t> data;
+    };
+
+    // one cache line, every probe touches a single line
+    struct alignas(64) Bucket {
+      Slot slots[SLOTS];
+    };
+
+    // data is move:16 score:16 depth:8 bound:2 age:6
+    static uint64_t pack(PackedMove move, int score, int depth,
+                         Bound bound, uint8_t age) {
+      return uint64_t(move.raw()) |
+             uint64_t(uint16_t(int16_t(score))) << 16 |
+             uint64_t(uint8_t(depth)) << 32 |
+             uint64_t(bound) << 40 |
+             uint64_t(age) << 42;
+    }
+    static PackedMove moveOf(uint64_t d) { return PackedMove::fromRaw(d & 0xFFFF); }
+    static int scoreOf(uint64_t d) { return int16_t(d >> 16); }
+    static int depthOf(uint64_t d) { return uint8_t(d >> 32); }
+    static Bound boundOf(uint64_t d) { return Bound((d >> 40) & 3); }
+    static uint8_t ageOf(uint64_t d) { return (d >> 42) & AGE_MASK; }
+
+    void allocate(size_t mb);
+    void release();
+
+    Bucket* _buckets = nullptr;
+    size_t _mask = 0;
+    size_t _bytes = 0;
+    size_t _size_mb = 0;
+    bool _huge_pages = false;
+    bool _mapped = false;
+    uint8_t _age = 0;
+};
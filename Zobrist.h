@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+// random keys xor'ed together to give every position a 64 bit hash,
+// generated at compile time from a fixed seed so they never change
+namespace Zobrist {
+
+  struct Keys {
+    // indexed like the piece bitboards, color * 6 + type - 1
+    uint64_t pieces[12][64];
+    uint64_t castling[16];
+    // by file, only hashed when the capture is actually possible
+    uint64_t passant[8];
+    uint64_t side;
+  };
+
+  constexpr Keys generate()
+  {
+    Keys k {};
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    auto next = [&state] {
+      // splitmix64
+      uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+      return z ^ (z >> 31);
+    };
+
+    for (auto& piece : k.pieces) {
+      for (auto& key : piece) {
+        key = next();
+      }
+    }
+    for (auto& key : k.castling) {
+      key = next();
+    }
+    for (auto& key : k.passant) {
+      key = next();
+    }
+    k.side = next();
+    return k;
+  }
+
+  inline constexpr Keys keys = generate();
+}
@@ -0,0 +1,324 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "OpeningBook.h"
+
+namespace {
+
+  struct Options {
+    // only the first plies of each game go in the book
+    int plies = 20;
+    // moves played fewer times than this are left out
+    int min_count = 1;
+  };
+
+  // times each move was played from each position, std::map keeps them in
+  // the order the book is written in
+  using Counts = std::map<std::pair<uint64_t, uint16_t>, uint32_t>;
+
+  /****************************************************************************
+   *
+   * Function: pieceFor(char)
+   *
+   ***************************************************************************/
+  PieceType pieceFor(char c)
+  {
+    switch (std::toupper(c)) {
+      case 'N': return KNIGHT;
+      case 'B': return BISHOP;
+      case 'R': return ROOK;
+      case 'Q': return QUEEN;
+      case 'K': return KING;
+      default:  return NONE;
+    }
+  }
+
+  /****************************************************************************
+   *
+   * Function: parseSan(game, san)
+   * - the legal move the SAN names, null if none or more than one does
+   ***************************************************************************/
+  PackedMove parseSan(BoardManager& game, std::string san)
+  {
+    // check marks and annotations say nothing about the move
+    while (!san.empty() &&
+           std::string("+#!?").find(san.back()) != std::string::npos)
+    {
+      san.pop_back();
+    }
+    std::replace(san.begin(), san.end(), '0', 'O');
+
+    const auto legal = game.genLegal(game.sideToMove());
+
+    if (san == "O-O" || san == "O-O-O") {
+      const auto flag = san == "O-O" ? PackedMove::KING_CASTLE
+                                     : PackedMove::QUEEN_CASTLE;
+      for (auto m : legal) {
+        if (m.flag() == flag) {
+          return m;
+        }
+      }
+      return PackedMove {};
+    }
+
+    PieceType promotion = NONE;
+    if (auto eq = san.find('='); eq != std::string::npos) {
+      promotion = eq + 1 < san.size() ? pieceFor(san[eq + 1]) : NONE;
+      san.resize(eq);
+    } else if (san.size() > 2 && pieceFor(san.back()) != NONE &&
+               std::isdigit(static_cast<unsigned char>(san[san.size() - 2])))
+    {
+      // e8Q, without the '='
+      promotion = pieceFor(san.back());
+      san.pop_back();
+    }
+
+    PieceType piece = PAWN;
+    if (!san.empty() && std::isupper(static_cast<unsigned char>(san[0]))) {
+      piece = pieceFor(san[0]);
+      san.erase(0, 1);
+    }
+    san.erase(std::remove(san.begin(), san.end(), 'x'), san.end());
+
+    if (san.size() < 2) {
+      return PackedMove {};
+    }
+
+    const int file = san[san.size() - 2] - 'a';
+    const int rank = san[san.size() - 1] - '1';
+    if (file < 0 || file > 7 || rank < 0 || rank > 7) {
+      return PackedMove {};
+    }
+    const Square to = (7 - rank) * 8 + file;
+
+    // whatever is left picks between two pieces that can both get there
+    const std::string from_hint = san.substr(0, san.size() - 2);
+
+    PackedMove found {};
+    for (auto m : legal) {
+      if (m.to() != to || game.pieceOn(m.from()).type != piece ||
+          m.promotion() != promotion)
+      {
+        continue;
+      }
+
+      bool fits = true;
+      for (char c : from_hint) {
+        if (c >= 'a' && c <= 'h') {
+          fits = fits && m.from() % 8 == c - 'a';
+        } else if (c >= '1' && c <= '8') {
+          fits = fits && 7 - m.from() / 8 == c - '1';
+        }
+      }
+
+      if (fits) {
+        if (found) {
+          return PackedMove {};
+        }
+        found = m;
+      }
+    }
+    return found;
+  }
+
+  /****************************************************************************
+   *
+   * Function: addGame(movetext, options, counts)
+   * - plays the game's moves from the start position, counting every one
+   *   inside the ply limit. Tags, comments, variations, NAGs, move numbers
+   *   and the result are skipped. Returns false if a move did not parse,
+   *   the moves before it are kept
+   ***************************************************************************/
+  bool addGame(const std::string& movetext, const Options& options,
+               Counts& counts)
+  {
+    BoardManager game;
+    int ply = 0;
+    int variation_depth = 0;
+
+    std::string token;
+    std::istringstream in(movetext);
+
+    while (ply < options.plies && in >> token) {
+      // comments and variations can run over several tokens
+      if (token.front() == '{') {
+        while (token.back() != '}' && in >> token) {}
+        continue;
+      }
+      variation_depth += std::count(token.begin(), token.end(), '(');
+      variation_depth -= std::count(token.begin(), token.end(), ')');
+      if (variation_depth > 0 || token.find(')') != std::string::npos) {
+        variation_depth = std::max(variation_depth, 0);
+        continue;
+      }
+
+      if (token.front() == '$' || token == "*" || token == "1-0" ||
+          token == "0-1" || token == "1/2-1/2")
+      {
+        continue;
+      }
+
+      if (token.size() > 4 && token.ends_with("e.p.")) {
+        token.resize(token.size() - 4);
+      }
+
+      // 12. and 12... in front of the move, sometimes joined to it
+      const auto dots = token.find_last_of('.');
+      if (dots != std::string::npos) {
+        token.erase(0, dots + 1);
+      }
+      if (token.empty()) {
+        continue;
+      }
+
+      const auto move = parseSan(game, token);
+      if (!move) {
+        return false;
+      }
+
+      counts[{ OpeningBook::polyglotKey(game),
+                OpeningBook::encode(move) }]++;
+      game.makeMove(move);
+      ply++;
+    }
+    return true;
+  }
+
+  /****************************************************************************
+   *
+   * Function: readPgn(path, options, counts)
+   * - a game's movetext is everything between its tag pairs and the next
+   *   game's, lines starting with ';' or '%' are comments
+   ***************************************************************************/
+  bool readPgn(const std::string& path, const Options& options,
+               Counts& counts)
+  {
+    std::ifstream file(path);
+    if (!file) {
+      std::cerr << "cannot read " << path << "\n";
+      return false;
+    }
+
+    int games = 0;
+    int bad = 0;
+    std::string movetext;
+    std::string line;
+
+    auto finish = [&] {
+      if (movetext.find_first_not_of(" \t\r\n") != std::string::npos) {
+        games++;
+        if (!addGame(movetext, options, counts)) {
+          bad++;
+        }
+      }
+      movetext.clear();
+    };
+
+    while (std::getline(file, line)) {
+      if (!line.empty() && (line[0] == ';' || line[0] == '%')) {
+        continue;
+      }
+      if (!line.empty() && line[0] == '[') {
+        finish();
+        continue;
+      }
+      if (auto semi = line.find(';'); semi != std::string::npos) {
+        line.resize(semi);
+      }
+      movetext += line;
+      movetext += ' ';
+    }
+    finish();
+
+    std::cout << path << ": " << games << " games";
+    if (bad) {
+      std::cout << ", " << bad << " cut short by a move that did not parse";
+    }
+    std::cout << "\n";
+    return true;
+  }
+
+  /****************************************************************************
+   *
+   * Function: writeBook(path, options, counts)
+   * - a position's moves are weighted by how often they were played,
+   *   scaled down so the most played fits in 16 bits
+   ***************************************************************************/
+  bool writeBook(const std::string& path, const Options& options,
+                 const Counts& counts)
+  {
+    uint32_t most = 1;
+    for (const auto& [key, count] : counts) {
+      most = std::max(most, count);
+    }
+    const double scale = most > 0xFFFF ? double(0xFFFF) / most : 1.0;
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+      std::cerr << "cannot write " << path << "\n";
+      return false;
+    }
+
+    size_t entries = 0;
+    unsigned char bytes[OpeningBook::ENTRY_SIZE];
+    for (const auto& [key, count] : counts) {
+      if (count < uint32_t(options.min_count)) {
+        continue;
+      }
+
+      const auto weight = std::max<uint32_t>(1, uint32_t(count * scale));
+      OpeningBook::write(bytes, { key.first, key.second, uint16_t(weight), 0 });
+      file.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+      entries++;
+    }
+
+    std::cout << path << ": " << entries << " entries\n";
+    return bool(file);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  const std::string usage =
+    "usage: makebook [options] <book.bin> <games.pgn>...\n"
+    "options:\n"
+    "       --plies <n>  how far into each game to go, 20 by default\n"
+    "       --min <n>    leave out moves played fewer than n times\n";
+
+  Options options;
+  std::vector<std::string> args;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--plies" && i + 1 < argc) {
+      options.plies = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--min" && i + 1 < argc) {
+      options.min_count = std::max(1, std::atoi(argv[++i]));
+    } else {
+      args.push_back(arg);
+    }
+  }
+
+  if (args.size() < 2) {
+    std::cerr << usage;
+    return 1;
+  }
+
+  Bitboards::init();
+
+  Counts counts;
+  for (size_t i = 1; i < args.size(); i++) {
+    if (!readPgn(args[i], options, counts)) {
+      return 1;
+    }
+  }
+
+  return writeBook(args[0], options, counts) ? 0 : 1;
+}
@@ -1,12 +1,14 @@
 #pragma once
 
-enum Color {
+#include <cstdint>
+
+enum Color : uint8_t {
   WHITE = 0,
   BLACK = 1,
   C_NONE = 2
 };
 
-enum PieceType {
+enum PieceType : uint8_t {
   NONE = 0,
   PAWN = 1,
   KNIGHT = 2,
@@ -32,5 +34,7 @@ struct Point {
 struct Move {
   Point from;
   Point to;
+  // only set for pawn moves to the last rank, NONE promotes to a queen
+  PieceType promotion = NONE;
 };
 
@@ -1,6 +1,7 @@
 #include "App.h"
 
 int main(int argc, char* argv[]) {
+  Bitboards::init();
   App gm;
   gm.run();
   return 0; 
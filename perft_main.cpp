@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include "Perft.h"
+
+// every heap allocation in the process, for the allocation benchmark
+static std::atomic<uint64_t> allocations = 0;
+
+void* operator new(std::size_t size)
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+  const char* START_FEN =
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+  struct Reference {
+    const char* name;
+    const char* fen;
+    int depth;
+    uint64_t nodes;
+  };
+
+  // standard positions and the usual edge cases, node counts are the
+  // published results every generator is compared against
+  const Reference suite[] = {
+    { "start position", START_FEN, 5, 4865609 },
+    { "kiwipete",
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+      4, 4085603 },
+    { "position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+      6, 11030083 },
+    { "position 4",
+      "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+      5, 15833292 },
+    { "position 5",
+      "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+      4, 2103487 },
+    { "position 6",
+      "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+      4, 3894594 },
+    { "illegal en passant, pinned on the rank",
+      "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1", 6, 1134888 },
+    { "illegal en passant, pinned on the diagonal",
+      "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1", 6, 1015133 },
+    { "en passant capture gives check",
+      "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", 6, 1440467 },
+    { "short castling gives check",
+      "5k2/8/8/8/8/8/8/4K2R w K - 0 1", 6, 661072 },
+    { "long castling gives check",
+      "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1", 6, 803711 },
+    { "castling rights",
+      "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1", 4, 1274206 },
+    { "castling prevented",
+      "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", 4, 1720476 },
+    { "promote out of check",
+      "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1", 6, 3821001 },
+    { "discovered check",
+      "8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1", 5, 1004658 },
+    { "promote to give check",
+      "4k3/1P6/8/8/8/8/K7/8 w - - 0 1", 6, 217342 },
+    { "underpromote to check",
+      "8/P1k5/K7/8/8/8/8/8 w - - 0 1", 6, 92683 },
+    { "self stalemate",
+      "K1k5/8/P7/8/8/8/8/8 w - - 0 1", 6, 2217 },
+    { "stalemate and checkmate",
+      "8/k1P5/8/1K6/8/8/8/8 w - - 0 1", 7, 567584 },
+    { "double check",
+      "8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1", 4, 23527 },
+  };
+
+  double secondsSince(std::chrono::steady_clock::time_point start)
+  {
+    return std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+  }
+
+  /****************************************************************************
+   *
+   * Function: runDivide(fen, depth, options)
+   *
+   ***************************************************************************/
+  int runDivide(const std::string& fen, int depth,
+                const Perft::Options& options)
+  {
+    BoardManager game(fen);
+    const auto start = std::chrono::steady_clock::now();
+
+    uint64_t total = 0;
+    for (auto [move, nodes] : Perft::divide(game, depth, options)) {
+      std::cout << moveToString(move) << ": " << nodes << "\n";
+      total += nodes;
+    }
+
+    const auto seconds = secondsSince(start);
+    std::cout << "\nNodes: " << total << "\n"
+              << "Time: " << seconds << "s\n"
+              << "Nodes/sec: " << uint64_t(total / seconds) << "\n";
+    return 0;
+  }
+
+  /****************************************************************************
+   *
+   * Function: runSuite(options)
+   *
+   ***************************************************************************/
+  int runSuite(const Perft::Options& options)
+  {
+    int failed = 0;
+    uint64_t total = 0;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (const auto& ref : suite) {
+      BoardManager game(ref.fen);
+      const auto position_start = std::chrono::steady_clock::now();
+      uint64_t nodes = 0;
+      for (auto d : Perft::divide(game, ref.depth, options)) {
+        nodes += d.nodes;
+      }
+      const auto ok = nodes == ref.nodes;
+
+      total += nodes;
+      failed += ok ? 0 : 1;
+      std::cout << (ok ? "ok    " : "FAIL  ") << ref.name
+                << " depth " << ref.depth << ": " << nodes;
+      if (!ok) {
+        std::cout << " expected " << ref.nodes;
+      }
+      std::cout << " (" << secondsSince(position_start) << "s)\n";
+    }
+
+    const auto seconds = secondsSince(start);
+    std::cout << "\n" << (std::size(suite) - failed) << "/"
+              << std::size(suite) << " passed, " << total << " nodes in "
+              << seconds << "s, " << uint64_t(total / seconds)
+              << " nodes/sec\n";
+    return failed ? 1 : 0;
+  }
+
+  /****************************************************************************
+   *
+   * Function: runBench()
+   * - heap allocations made by move generation, then raw speed
+   ***************************************************************************/
+  int runBench()
+  {
+    BoardManager game(START_FEN);
+
+    auto before = allocations.load();
+    auto legal = game.genLegal(WHITE);
+    std::cout << "genLegal, start position: " << legal.size()
+              << " moves, " << allocations.load() - before
+              << " allocations\n";
+
+    before = allocations.load();
+    const auto start = std::chrono::steady_clock::now();
+    const auto nodes = Perft::count(game, 6);
+    const auto seconds = secondsSince(start);
+    std::cout << "perft 6, start position: " << nodes << " nodes, "
+              << allocations.load() - before << " allocations, "
+              << uint64_t(nodes / seconds) << " nodes/sec\n";
+    return 0;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  const std::string usage =
+    "usage: perft [options] <fen|startpos> <depth>\n"
+    "       perft [options] --suite\n"
+    "       perft --bench\n"
+    "options:\n"
+    "       --threads <n>   split the tree over n threads\n"
+    "       --hash-mb <mb>  reuse subtree counts from a shared hash table\n";
+
+  Perft::Options options;
+  std::vector<std::string> args;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg == "--threads" && i + 1 < argc) {
+      options.threads = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--hash-mb" && i + 1 < argc) {
+      options.hash_mb = std::max(0, std::atoi(argv[++i]));
+    } else {
+      args.push_back(arg);
+    }
+  }
+
+  Bitboards::init();
+
+  if (args.size() == 1 && args[0] == "--suite") {
+    return runSuite(options);
+  }
+
+  if (args.size() == 1 && args[0] == "--bench") {
+    return runBench();
+  }
+
+  if (args.size() == 2) {
+    const auto& fen = args[0];
+    return runDivide(fen == "startpos" ? START_FEN : fen,
+                     std::atoi(args[1].c_str()), options);
+  }
+
+  std::cerr << usage;
+  return 1;
+}